@@ -1,5 +1,19 @@
 #include "bit.h"
 
+/*
+ * Ce fichier est la couche la plus basse du codage entropique :
+ * toutes les fonctions travaillant sur les bits d'un entier.
+ *
+ * Elles utilisent les instructions du processeur qui comptent
+ * les zéros à gauche ou à droite quand le compilateur les connaît,
+ * sinon une version portable.
+ */
+
+/*
+ * Nombre de bits dans un "unsigned long"
+ */
+#define NB_BITS_LONG (8*sizeof(unsigned long))
+
 /*
  * Retourne le nombre de bits utilisé pour coder l'entier
  * Voici quelques chiffres :
@@ -11,12 +25,26 @@
  *
  * (Vous perdez des points de TP si vous utilisez une fonction travaillant
  * avec des nombres flottants)
+ *
+ * C'est le nombre de bits moins le nombre de zéros à gauche.
  */
 
 unsigned int nb_bits_utile(unsigned long v)
 {
   if(v)
-    return nb_bits_utile(v/2) + 1 ;
+#ifdef __GNUC__
+    return NB_BITS_LONG - __builtin_clzl(v) ;
+#else
+    {
+      unsigned int n = 0;
+      while(v)
+	{
+	  v >>= 1;
+	  n++;
+	}
+      return n;
+    }
+#endif
   else
     return 0;
 }
@@ -40,15 +68,16 @@ unsigned int nb_bits_utile(unsigned long v)
  * En fait, cette fonction est équivalente à "pow(2,position)"
  * (Vous perdez des points de TP si vous utilisez une fonction travaillant
  * avec des nombres flottants)
+ *
+ * Si la position est hors de l'entier, on retourne 0.
  */
 
 unsigned long pow2(Position_Bit position)
 {
-  if(position < 32)
-    return 1 << position;
-  else 
+  if(position < NB_BITS_LONG)
+    return 1UL << position;
+  else
     return 0;
-  return 1 ;
 }
 
 
@@ -65,12 +94,10 @@ Booleen prend_bit(unsigned long c,	     /* L'entier où on prend le bit */
 		  Position_Bit position	     /* La position du bit pris */
 		  )
 {
-  while(position)
-    {
-      c /= 2;
-      position--;
-    }
-  return c % 2;
+  if(position < NB_BITS_LONG)
+    return (c >> position) & 1;
+  else
+    return Faux;
 }
 
 /*
@@ -88,5 +115,33 @@ unsigned long pose_bit(unsigned long c,	      /* Entier à modifier */
   if(bit)
     return c | valeur_ajoute;
   else
-    return c & ~valeur_ajoute; 
+    return c & ~valeur_ajoute;
+}
+
+/*
+ * Nombre de zéros à droite du premier bit à 1.
+ * C'est la position du bit à 1 de poids le plus faible.
+ *
+ * nb_zeros_a_droite(1) ==> 0
+ * nb_zeros_a_droite(12) ==> 2
+ * nb_zeros_a_droite(0) ==> le nombre de bits d'un "unsigned long"
+ */
+
+unsigned int nb_zeros_a_droite(unsigned long v)
+{
+  if(v == 0)
+    return NB_BITS_LONG;
+#ifdef __GNUC__
+  return __builtin_ctzl(v);
+#else
+  {
+    unsigned int n = 0;
+    while((v & 1) == 0)
+      {
+	v >>= 1;
+	n++;
+      }
+    return n;
+  }
+#endif
 }
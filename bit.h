@@ -19,5 +19,6 @@ unsigned int nb_bits_utile(unsigned long) ;
 unsigned long         pow2(Position_Bit) ;
 Booleen          prend_bit(unsigned long, Position_Bit) ;
 unsigned long     pose_bit(unsigned long, Position_Bit, Booleen) ;
+unsigned int nb_zeros_a_droite(unsigned long) ;
 
 #endif
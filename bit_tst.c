@@ -23,7 +23,7 @@ void pow2_tst()
       eprintf("pow2(0) != 1\n") ;
       return ;
     }
-  for(i=0;i<31;i++)
+  for(i=0;i<8*sizeof(unsigned long)-1;i++)
     if ( pow2(i+1) != pow2(i)*2 )
       {
 	eprintf("pow2(%d) != pow2(%d)*2\n", i+1, i) ;
@@ -92,3 +92,22 @@ void pose_bit_tst()
 	}
     }	
 }
+
+void nb_zeros_a_droite_tst()
+{
+  int k ;
+
+  if ( nb_zeros_a_droite(0) != 8*sizeof(unsigned long) )
+    {
+      eprintf("nb_zeros_a_droite(0) = %d\n", nb_zeros_a_droite(0)) ;
+      return ;
+    }
+  for(k=0; k < 8*sizeof(unsigned long); k++)
+    if ( nb_zeros_a_droite(pow2(k)) != k
+	 || nb_zeros_a_droite(pow2(k) | pow2(8*sizeof(unsigned long)-1)) != k )
+      {
+	eprintf("nb_zeros_a_droite(pow2(%d)) != %d\n", k, k) ;
+	return ;
+      }
+}
+
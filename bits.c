@@ -6,16 +6,19 @@
  * dans le fichier (toujours du poids fort au faible).
  *
  * Pour v=11 nb=8 on va écrire les bits : 00001011 dans le fichier
+ *
+ * Les bits sont posés par paquets de NB_BITS_MOT avec "put_mot"
+ * et non plus un par un.
  */
 
 void put_bits(struct bitstream *b, unsigned int nb, unsigned long v)
 {
-  int i;
-  //Revoir le cas nb=0
-  for(i = nb-1; i>=0; i--)
+  while(nb > NB_BITS_MOT)
     {
-      put_bit(b, prend_bit(v, i));
+      nb -= NB_BITS_MOT;
+      put_mot(b, NB_BITS_MOT, (Buffer_Bit)v >> nb);
     }
+  put_mot(b, nb, v);
 }
 
 
@@ -29,14 +32,14 @@ void put_bits(struct bitstream *b, unsigned int nb, unsigned long v)
 
 unsigned int get_bits(struct bitstream *b, unsigned int nb)
 {
-  int i;
-  int res = 0;
-  for(i = 0; i < nb ; i++)
+  Buffer_Bit res = 0;
+
+  while(nb > NB_BITS_MOT)
     {
-      res = pose_bit(res, nb-1-i, get_bit(b));
-      // res = 2*res + get_bit(b)
+      nb -= NB_BITS_MOT;
+      res = (res << NB_BITS_MOT) | get_mot(b, NB_BITS_MOT);
     }
-    return res;
+  return (res << nb) | get_mot(b, nb);
 }
 
 /*
@@ -45,17 +48,20 @@ unsigned int get_bits(struct bitstream *b, unsigned int nb)
  * dans le flot de bit sous la forme d'une suite de bit 0 et 1.
  *
  * Comme d'habitude le caractère '0' c'est Faux les autres sont vrai
+ *
+ * Les bits sont regroupés dans un mot avant d'être écrits.
  */
 
 void put_bit_string(struct bitstream *b, const char *bits)
 {
-  while(*bits != '\0') // On peut utiliser bit[i]
-    { 
-      put_bit(b, *bits++ != '0');
-      /*if(*bits=='0')
-    	put_bit(b, Faux);
-    else
- 	put_bit(b, Vrai);
-	bits++;*/
-  }
+  Buffer_Bit mot;
+  Position_Bit nb;
+
+  while(*bits != '\0')
+    {
+      mot = 0;
+      for(nb = 0; nb < NB_BITS_MOT && *bits != '\0'; nb++)
+	mot = (mot << 1) | (*bits++ != '0');
+      put_mot(b, nb, mot);
+    }
 }
@@ -1,3 +1,8 @@
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <pthread.h>
+
 #include "bitstream.h"
 #include "exception.h"
 #include "bit.h"
@@ -8,10 +13,70 @@
  * On ne mélange pas écriture et lecture, on ouvre pour lire OU
  * pour écrire, pas les 2.
  *
- * Le principe est simple on utilise un buffer d'entrée/sortie.
- * On ne fait réellement la sortie que lorsque le buffer est plein
- * ou l'entrée quand il est vide.
+ * Le principe est simple on utilise deux niveaux de tampon :
+ *    - un accumulateur de 64 bits dans lequel on pose/prend les bits,
+ *    - un bloc de TAILLE_BLOC octets entre l'accumulateur et le fichier.
+ * On ne fait réellement la sortie que lorsque le bloc est plein
+ * ou l'entrée quand il est vide : un seul "fwrite"/"fread"
+ * pour 64 Kio au lieu d'un appel par octet.
+ *
+ * Le flot peut aussi être en mémoire (voir "open_bitstream_memory"),
+ * le bloc est alors directement le tableau d'octets de l'utilisateur
+ * et il n'y a plus aucune entrée/sortie.
+ *
+ * Un fichier normal ouvert en lecture est projeté en mémoire ("mmap"),
+ * le bloc est alors tout le fichier et les bits sont pris directement
+ * dans le cache des pages du système, sans recopie.
+ *
+ * En écriture asynchrone (voir "open_bitstream_async") les blocs pleins
+ * sont écrits par un processus léger pendant que le codeur remplit
+ * le bloc suivant.
+ *
+ * Le flot de comptage (voir "open_bitstream_comptage") ne stocke rien,
+ * il compte seulement les bits pour connaître la taille exacte
+ * qu'aurait le flot.
+ */
+
+/*
+ * Où sont les octets du flot.
+ */
+typedef enum
+{
+  Support_fichier,		/* Le bloc est vidé/rempli dans "fichier" */
+  Support_memoire,		/* Le bloc est le flot lui-même */
+  Support_projection,		/* Le bloc est le fichier projeté */
+  Support_asynchrone,		/* Le bloc est écrit par "ecrivain" */
+  Support_comptage		/* Le bloc est seulement compté */
+} Support ;
+
+/*
+ * Taille du bloc d'un flot de comptage, il n'est jamais écrit.
  */
+#define TAILLE_BLOC_COMPTAGE 256
+
+/*
+ * Nombre de blocs dans l'anneau de l'écriture asynchrone.
+ */
+#define NB_BLOCS_ASYNC 4
+
+/*
+ * L'anneau de blocs partagé entre le codeur et le processus léger
+ * qui fait les écritures.
+ * Les "nb_pleins" blocs à partir de "premier" attendent d'être écrits,
+ * le codeur remplit le bloc qui suit.
+ */
+struct ecrivain
+{
+  pthread_t       processus ;
+  pthread_mutex_t verrou ;
+  pthread_cond_t  condition ;	     /* Un bloc a été ajouté ou écrit */
+  unsigned char  *blocs[NB_BLOCS_ASYNC] ;
+  size_t          longueurs[NB_BLOCS_ASYNC] ;
+  int             premier ;	     /* Prochain bloc à écrire */
+  int             nb_pleins ;	     /* Nb blocs en attente d'écriture */
+  Booleen         fin ;		     /* Plus de bloc à venir */
+  Booleen         erreur ;	     /* Une écriture a échoué */
+} ;
 
 
 /*
@@ -19,18 +84,32 @@
  * permettant d'ecrire (ou de lire) les bits un par un dans un fichier.
  * Evidemment aucune fonction de gestion de fichier ne permet de faire cela.
  * On va donc stocker les bits un par un dans un entier (buffer)
- * et quand celui-ci sera plein, on le stockera dans le fichier.
+ * et quand celui-ci sera plein, on le recopie octet par octet
+ * (poids fort en premier) dans le bloc.
+ * Quand le bloc est plein on l'écrit dans le fichier.
+ *
+ * Pour la lecture, le procédé est inverse, on lit un bloc.
+ * On remplit l'accumulateur avec les octets du bloc
+ * puis on en extrait les bits un par un jusqu'à ce qu'il soit vide.
  *
- * Pour la lecture, le procédé est inverse, on lit le buffer.
- * Puis on en extrait les bits un par un
- * jusqu'à ce qu'il soit vide.
+ * Les bits utiles de l'accumulateur sont toujours cadrés à droite :
+ * ce sont les "nb_bits_dans_buffer" bits de poids faible.
  */
 struct bitstream
 {
   FILE          *fichier ;		     /* En lecture ou Ecriture */
-  Buffer_Bit     buffer ;		     /* Tampon intermediaire */
-  Position_Bit   nb_bits_dans_buffer ;	     /* Nb bits dans le tampon */
+  Buffer_Bit     buffer ;		     /* Accumulateur */
+  Position_Bit   nb_bits_dans_buffer ;	     /* Nb bits dans l'accumulateur */
   Booleen        ecriture ;		     /* Faux, si ouvert avec "r" */
+  Support        support ;		     /* Fichier ou mémoire */
+  unsigned char *bloc ;			     /* Bloc d'entrée/sortie */
+  size_t         taille_bloc ;		     /* Taille allouée du bloc */
+  size_t         position_bloc ;	     /* Prochain octet du bloc */
+  size_t         fin_bloc ;		     /* Nb octets valides (lecture) */
+  Booleen        bloc_alloue ;		     /* Le bloc est libéré à la fin */
+  Booleen        extensible ;		     /* Bloc mémoire agrandi si plein */
+  struct ecrivain *ecrivain ;		     /* Si écriture asynchrone */
+  unsigned long long octets_sortis ;	     /* Nb octets sortis du bloc */
 } ;
 
 /*
@@ -55,25 +134,70 @@ struct bitstream
  * Pour plus d'explications sur les exceptions, regardez "exception.h"
  */
 
-struct bitstream *open_bitstream(const char *fichier, const char* mode)
+static struct bitstream *allocation_bitstream(Support support)
 {
   struct bitstream *struct_stockage ;
   ALLOUER(struct_stockage, 1) ;
+  struct_stockage->fichier = NULL;
   struct_stockage->nb_bits_dans_buffer = 0;
+  struct_stockage->buffer = 0;
+  struct_stockage->support = support;
+  struct_stockage->bloc = NULL;
+  struct_stockage->taille_bloc = 0;
+  struct_stockage->position_bloc = 0;
+  struct_stockage->fin_bloc = 0;
+  struct_stockage->bloc_alloue = Faux;
+  struct_stockage->extensible = Faux;
+  struct_stockage->ecrivain = NULL;
+  struct_stockage->octets_sortis = 0;
+  return struct_stockage;
+}
+
+/*
+ * Projette en mémoire le fichier ouvert en lecture si c'est un fichier
+ * normal non vide. Retourne Faux si ce n'est pas possible
+ * (tube, terminal...), la lecture se fait alors par blocs.
+ */
+
+static Booleen projection_fichier(struct bitstream *b)
+{
+  struct stat st;
+  void *projection;
+
+  if(fstat(fileno(b->fichier), &st) != 0
+     || !S_ISREG(st.st_mode) || st.st_size == 0)
+    return Faux;
+
+  projection = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE
+		    , fileno(b->fichier), 0);
+  if(projection == MAP_FAILED)
+    return Faux;
+  madvise(projection, st.st_size, MADV_SEQUENTIAL);
+
+  b->support = Support_projection;
+  b->bloc = projection;
+  b->taille_bloc = st.st_size;
+  b->fin_bloc = st.st_size;
+  return Vrai;
+}
+
+struct bitstream *open_bitstream(const char *fichier, const char* mode)
+{
+  struct bitstream *struct_stockage = allocation_bitstream(Support_fichier) ;
 
   //Ouver en lecture
-  if(*mode == 'r') 
-    struct_stockage->ecriture = 0;    
+  if(*mode == 'r')
+    struct_stockage->ecriture = 0;
   else
     struct_stockage->ecriture = 1;
 
   //Si le nom de fichier est '-'
-  if(*fichier == '-' && strlen(fichier) == 1) 
+  if(*fichier == '-' && strlen(fichier) == 1)
     {
       //Si on est en mode lecture
       if(struct_stockage->ecriture)
-	struct_stockage->fichier = stdout; 
-      else 
+	struct_stockage->fichier = stdout;
+      else
 	struct_stockage->fichier = stdin;
     }
   else
@@ -86,38 +210,325 @@ struct bitstream *open_bitstream(const char *fichier, const char* mode)
 	  free(struct_stockage) ;
 	  EXCEPTION_LANCE(Exception_fichier_ouverture);
 	}
+
+      if(!struct_stockage->ecriture && projection_fichier(struct_stockage))
+	return struct_stockage;
     }
-	
+
+  ALLOUER(struct_stockage->bloc, TAILLE_BLOC) ;
+  struct_stockage->taille_bloc = TAILLE_BLOC;
+  struct_stockage->bloc_alloue = Vrai;
+
   return struct_stockage;
 }
 
+/*
+ * Ouverture en écriture d'un flot de bits en mémoire.
+ *
+ * Si "buffer" n'est pas NULL, les octets sont écrits dedans
+ * et il ne faut pas dépasser "taille" octets, sinon on lance l'exception
+ *         Exception_fichier_ecriture
+ *
+ * Si "buffer" est NULL, le tableau est alloué (avec "taille" octets
+ * au départ) et agrandi quand il est plein.
+ * Il est libéré par "close_bitstream".
+ *
+ * Le contenu est récupéré avec "bitstream_memory".
+ */
+
+struct bitstream *open_bitstream_memory(unsigned char *buffer, size_t taille)
+{
+  struct bitstream *b = allocation_bitstream(Support_memoire) ;
+
+  b->ecriture = Vrai;
+  if(buffer == NULL)
+    {
+      if(taille == 0)
+	taille = 1024;
+      ALLOUER(b->bloc, taille);
+      b->bloc_alloue = Vrai;
+      b->extensible = Vrai;
+    }
+  else
+    b->bloc = buffer;
+  b->taille_bloc = taille;
+
+  return b;
+}
+
+/*
+ * Ouverture d'un flot de bits en écriture qui ne fait aucune
+ * entrée/sortie : les bits sont seulement comptés.
+ * On y écrit avec les fonctions habituelles ("put_entier",
+ * "compresse"...) puis "bitstream_nb_bits" donne la taille exacte
+ * qu'aurait le flot, pour choisir un paramètre sans rien écrire.
+ */
+
+struct bitstream *open_bitstream_comptage()
+{
+  struct bitstream *b = allocation_bitstream(Support_comptage) ;
+
+  b->ecriture = Vrai;
+  ALLOUER(b->bloc, TAILLE_BLOC_COMPTAGE);
+  b->taille_bloc = TAILLE_BLOC_COMPTAGE;
+  b->bloc_alloue = Vrai;
+
+  return b;
+}
+
+/*
+ * Ouverture en lecture d'un flot de bits qui est dans
+ * les "taille" octets de "buffer". Le tableau n'est pas copié,
+ * il doit rester valide jusqu'au "close_bitstream".
+ */
+
+struct bitstream *open_bitstream_memory_read(const unsigned char *buffer
+					     , size_t taille)
+{
+  struct bitstream *b = allocation_bitstream(Support_memoire) ;
+
+  b->ecriture = Faux;
+  b->bloc = (unsigned char*)buffer;
+  b->taille_bloc = taille;
+  b->fin_bloc = taille;
+
+  return b;
+}
+
+/*
+ * Le processus léger de l'écriture asynchrone.
+ * Il écrit les blocs pleins dans l'ordre jusqu'à ce que
+ * "close_bitstream" indique la fin.
+ * Il ne peut pas lancer d'exception, une erreur est notée
+ * dans "erreur" et les blocs suivants sont ignorés.
+ */
+
+static void *ecriture_asynchrone(void *arg)
+{
+  struct bitstream *b = arg;
+  struct ecrivain *e = b->ecrivain;
+  Booleen erreur;
+  int i;
+
+  pthread_mutex_lock(&e->verrou);
+  for(;;)
+    {
+      while(e->nb_pleins == 0 && !e->fin)
+	pthread_cond_wait(&e->condition, &e->verrou);
+      if(e->nb_pleins == 0)
+	break;
+      i = e->premier;
+      erreur = e->erreur;
+      pthread_mutex_unlock(&e->verrou);
+
+      //L'écriture se fait sans le verrou, le codeur continue
+      if(!erreur
+	 && fwrite(e->blocs[i], 1, e->longueurs[i], b->fichier)
+	 != e->longueurs[i])
+	erreur = Vrai;
+
+      pthread_mutex_lock(&e->verrou);
+      e->erreur = erreur;
+      e->premier = (e->premier + 1) % NB_BLOCS_ASYNC;
+      e->nb_pleins--;
+      pthread_cond_signal(&e->condition);
+    }
+  pthread_mutex_unlock(&e->verrou);
+  return NULL;
+}
+
+/*
+ * Ouverture en écriture asynchrone, le fichier est ouvert
+ * comme avec "open_bitstream" (et "-" est la sortie standard).
+ *
+ * Les blocs pleins sont écrits par un processus léger :
+ * le codage continue pendant les entrées/sorties.
+ * Une erreur d'écriture ne peut être signalée qu'au bloc suivant
+ * ou par "close_bitstream", avec l'exception
+ *         Exception_fichier_ecriture
+ */
+
+struct bitstream *open_bitstream_async(const char *fichier)
+{
+  struct bitstream *b = open_bitstream(fichier, "w") ;
+  struct ecrivain *e ;
+  int i ;
+
+  ALLOUER(e, 1) ;
+  for(i=0; i<NB_BLOCS_ASYNC; i++)
+    ALLOUER(e->blocs[i], TAILLE_BLOC) ;
+  e->premier = 0;
+  e->nb_pleins = 0;
+  e->fin = Faux;
+  e->erreur = Faux;
+  pthread_mutex_init(&e->verrou, NULL);
+  pthread_cond_init(&e->condition, NULL);
+
+  //Le bloc de "open_bitstream" est remplacé par ceux de l'anneau
+  free(b->bloc);
+  b->bloc = e->blocs[0];
+  b->bloc_alloue = Faux;
+  b->support = Support_asynchrone;
+  b->ecrivain = e;
+
+  if(pthread_create(&e->processus, NULL, ecriture_asynchrone, b) != 0)
+    {
+      fprintf(stderr, "Ne peut pas créer le processus d'écriture\n") ;
+      EXIT ;
+    }
+  return b;
+}
+
+/*
+ * Arrête le processus d'écriture après qu'il ait écrit
+ * tous les blocs et libère l'anneau.
+ * Retourne Faux si une écriture a échoué.
+ */
+
+static Booleen arret_ecrivain(struct bitstream *b)
+{
+  struct ecrivain *e = b->ecrivain;
+  Booleen erreur;
+  int i;
+
+  pthread_mutex_lock(&e->verrou);
+  e->fin = Vrai;
+  pthread_cond_signal(&e->condition);
+  pthread_mutex_unlock(&e->verrou);
+  pthread_join(e->processus, NULL);
+
+  erreur = e->erreur;
+  pthread_mutex_destroy(&e->verrou);
+  pthread_cond_destroy(&e->condition);
+  for(i=0; i<NB_BLOCS_ASYNC; i++)
+    free(e->blocs[i]);
+  free(e);
+  b->ecrivain = NULL;
+  b->bloc = NULL;
+  return !erreur;
+}
+
+/*
+ * Ecrit dans le fichier les octets en attente dans le bloc.
+ * En mémoire il n'y a rien à écrire, on fait de la place
+ * si le bloc est plein.
+ *
+ * Si il y a une erreur d'écriture, elle lance l'exception :
+ *         "Exception_fichier_ecriture"
+ */
+
+static void vide_bloc(struct bitstream *b)
+{
+  switch(b->support)
+    {
+    case Support_fichier:
+      if(b->position_bloc != 0)
+	{
+	  if(fwrite(b->bloc, 1, b->position_bloc, b->fichier)
+	     != b->position_bloc)
+	    EXCEPTION_LANCE(Exception_fichier_ecriture);
+	  b->octets_sortis += b->position_bloc;
+	  b->position_bloc = 0;
+	}
+      break;
+    case Support_asynchrone:
+      //Le bloc est donné au processus d'écriture
+      //et on attend qu'un bloc de l'anneau soit libre
+      if(b->position_bloc != 0)
+	{
+	  struct ecrivain *e = b->ecrivain;
+	  Booleen erreur;
+
+	  pthread_mutex_lock(&e->verrou);
+	  e->longueurs[(e->premier + e->nb_pleins) % NB_BLOCS_ASYNC]
+	    = b->position_bloc;
+	  e->nb_pleins++;
+	  pthread_cond_signal(&e->condition);
+	  while(e->nb_pleins == NB_BLOCS_ASYNC)
+	    pthread_cond_wait(&e->condition, &e->verrou);
+	  b->bloc = e->blocs[(e->premier + e->nb_pleins) % NB_BLOCS_ASYNC];
+	  erreur = e->erreur;
+	  pthread_mutex_unlock(&e->verrou);
+	  b->octets_sortis += b->position_bloc;
+	  b->position_bloc = 0;
+	  if(erreur)
+	    EXCEPTION_LANCE(Exception_fichier_ecriture);
+	}
+      break;
+    case Support_comptage:
+      //Les octets sont oubliés
+      b->octets_sortis += b->position_bloc;
+      b->position_bloc = 0;
+      break;
+    case Support_projection:
+      //Jamais en écriture
+      break;
+    case Support_memoire:
+      //Les octets restent dans le bloc, on agrandit s'il est plein
+      if(b->position_bloc == b->taille_bloc)
+	{
+	  if(!b->extensible)
+	    EXCEPTION_LANCE(Exception_fichier_ecriture);
+	  b->taille_bloc *= 2;
+	  b->bloc = realloc(b->bloc, b->taille_bloc);
+	  if(b->bloc == NULL)
+	    {
+	      fprintf(stderr, "Plus de memoire\n") ;
+	      EXIT ;
+	    }
+	}
+      break;
+    }
+}
+
+/*
+ * Recopie dans le bloc tous les octets complets de l'accumulateur,
+ * du poids fort au poids faible.
+ * Il reste au plus 7 bits dans l'accumulateur après l'appel.
+ */
+
+static void vide_accumulateur(struct bitstream *b)
+{
+  while(b->nb_bits_dans_buffer >= 8)
+    {
+      if(b->position_bloc == b->taille_bloc)
+	vide_bloc(b);
+      b->nb_bits_dans_buffer -= 8;
+      b->bloc[b->position_bloc++] = b->buffer >> b->nb_bits_dans_buffer;
+    }
+}
+
 /*
  * Cette fonction ne fait rien si le fichier est ouvert en lecture.
- * 
+ *
  * Si le buffer n'est pas vide :
  *    - Cette fonction stocke le buffer dans le fichier
  *      que le buffer soit "complet" ou non.
+ *      Le dernier octet est complété par des bits à 0.
  *      Elle ne stocke rien si le buffer est vide
  *    - Elle vide ensuite le buffer.
  * Cette fonction n'est appelée que lorsque le fichier est ouvert
  * en écriture.
  *
  * Si il y a une erreur d'écriture, elle lance l'exception :
- *         "Exception_fichier_ecriture"  
+ *         "Exception_fichier_ecriture"
  */
 
 void flush_bitstream(struct bitstream *b)
 {
   if(b->ecriture)
     {
+      vide_accumulateur(b);
       if(b->nb_bits_dans_buffer != 0)
 	{
-	  if(fwrite(&b->buffer, NB_BITS / 8, 1, b->fichier) == 0 )
-	    EXCEPTION_LANCE(Exception_fichier_ecriture);
-
-	  //Vide buffer
-	  b->nb_bits_dans_buffer = 0;
+	  //Complete le dernier octet avec des 0
+	  b->buffer <<= 8 - b->nb_bits_dans_buffer;
+	  b->nb_bits_dans_buffer = 8;
+	  vide_accumulateur(b);
 	}
+      //En mémoire les octets sont déjà à leur place
+      if(b->support != Support_memoire)
+	vide_bloc(b);
     }
 }
 
@@ -128,24 +539,53 @@ void flush_bitstream(struct bitstream *b)
  *
  * Si jamais, il y a une erreur de fermeture, on lance l'exception
  *         Exception_fichier_fermeture
+ *
+ * En écriture asynchrone on attend la fin des écritures,
+ * si l'une d'elles a échoué on lance l'exception
+ *         Exception_fichier_ecriture
+ * Le processus d'écriture est arrêté même si c'est le dernier
+ * bloc qui lance l'exception.
  */
 
 void close_bitstream(struct bitstream *b)
-{	
-  flush_bitstream(b);
+{
+  if(b->ecrivain != NULL)
+    {
+      EXCEPTION(flush_bitstream(b)
+		,
+		,
+		case Exception_fichier_ecriture:
+		//"arret_ecrivain" trouve l'erreur
+		break;
+		);
+    }
+  else
+    flush_bitstream(b);
 
-  if(fclose(b->fichier) != 0)
+  if(b->ecrivain != NULL && !arret_ecrivain(b))
+    {
+      fclose(b->fichier);
+      free(b);
+      EXCEPTION_LANCE(Exception_fichier_ecriture);
+    }
+
+  if(b->fichier != NULL && fclose(b->fichier) != 0)
     EXCEPTION_LANCE(Exception_fichier_fermeture);
 
+  if(b->support == Support_projection)
+    munmap(b->bloc, b->taille_bloc);
+  if(b->bloc_alloue)
+    free(b->bloc);
   free(b);
 }
 
 /*
- * Cette fonction ajoute le "bit" dans le buffer.
- *    - Si celui-ci est plein, alors on sauvegarde le buffer
- *      dans le fichier avec "flush_bitstream".
+ * Cette fonction ajoute le "bit" dans l'accumulateur.
+ *    - Si celui-ci est plein, alors on recopie ses octets
+ *      dans le bloc avec "vide_accumulateur".
+ *      (le bloc lui-même n'est écrit que lorsqu'il est plein)
  *
- *    - On pose le bit dans le buffer.
+ *    - On pose le bit dans l'accumulateur.
  *
  * Cette fonction n'est appelée que lorsque
  * le fichier est ouvert en écriture.
@@ -161,20 +601,60 @@ void put_bit(struct bitstream *b, Booleen bit)
 {
   if(b->ecriture)//Si on est bien en ecriture
     {
-      b->buffer = pose_bit(b->buffer, NB_BITS - 1 - b->nb_bits_dans_buffer, bit);
+      b->buffer = (b->buffer << 1) | (bit != Faux);
       b->nb_bits_dans_buffer++;
-      if(b->nb_bits_dans_buffer == NB_BITS)//Si le buffer est plein
-	flush_bitstream(b);//On le vide ajoute dans le fichier
+      if(b->nb_bits_dans_buffer == NB_BITS)//Si l'accumulateur est plein
+	vide_accumulateur(b);//On le recopie dans le bloc
     }
   else
     EXCEPTION_LANCE(Exception_fichier_ecriture_dans_fichier_ouvert_en_lecture);
-	
+
 }
 
+/*
+ * Lit un nouveau bloc dans le fichier.
+ * Retourne Faux si il n'y a plus rien à lire.
+ */
+
+static Booleen remplit_bloc(struct bitstream *b)
+{
+  switch(b->support)
+    {
+    case Support_fichier:
+      b->fin_bloc = fread(b->bloc, 1, b->taille_bloc, b->fichier);
+      b->position_bloc = 0;
+      return b->fin_bloc != 0;
+    case Support_memoire:
+    case Support_projection:
+    case Support_asynchrone:
+    case Support_comptage:
+      //Tout le flot est déjà dans le bloc (ou jamais en lecture)
+      break;
+    }
+  return Faux;
+}
+
+/*
+ * Complète l'accumulateur avec les octets du bloc
+ * tant qu'il reste la place pour un octet entier.
+ * Il contient au moins 57 bits après l'appel, sauf en fin de fichier.
+ */
+
+static void remplit_accumulateur(struct bitstream *b)
+{
+  while(b->nb_bits_dans_buffer <= NB_BITS - 8)
+    {
+      if(b->position_bloc == b->fin_bloc && !remplit_bloc(b))
+	break;
+      b->buffer = (b->buffer << 8) | b->bloc[b->position_bloc++];
+      b->nb_bits_dans_buffer += 8;
+    }
+}
 
 /*
  * Cette fonction lit un bit du buffer (du poid fort au poid faible)
- * Si le buffer est vide, elle va le lire dans le fichier.
+ * Si le buffer est vide, elle va le remplir à partir du bloc,
+ * lui même lu dans le fichier quand il est épuisé.
  * Les valeurs retournées possibles sont :
  *    - (Faux)
  *    - (Vrai)
@@ -182,12 +662,6 @@ void put_bit(struct bitstream *b, Booleen bit)
  * Cette fonction n'est appelée que lorsque
  * le fichier est ouvert en lecture.
  *
- * ATTENTION ATTENTION : fgetc() RETOURNE UN int, PAS UN char.
- * faites donc attention aux affectations et aux tests par rapport à EOF.
- * Posez-vous les questions :
- *    - Pourquoi la valeur de retour est "int" et non "char"
- *    - Quel est le type de "b->buffer"
- *
  * En cas d'erreur de lecture (fin de fichier) on lance l'exception
  *         Exception_fichier_lecture
  *
@@ -197,28 +671,17 @@ void put_bit(struct bitstream *b, Booleen bit)
 
 Booleen get_bit(struct bitstream *b)
 {
-  Booleen valeur_retour;
   if(!b->ecriture)//Si on est en lecture
     {
       if(b->nb_bits_dans_buffer == 0)
 	{
-	  /*int temp;
-	    temp = fgetc(b->fichier);
-	    if(temp == EOF)			
+	  remplit_accumulateur(b);
+	  if(b->nb_bits_dans_buffer == 0)
 	    EXCEPTION_LANCE(Exception_fichier_lecture);
-	    b->buffer = (unsigned char)temp;*/
-		
-	  b->buffer = fgetc(b->fichier);	
-	  if(feof(b->fichier))
-	    EXCEPTION_LANCE(Exception_fichier_lecture);
-				
-	  b->nb_bits_dans_buffer = NB_BITS;
 	}
 
-      valeur_retour = prend_bit(b->buffer, b->nb_bits_dans_buffer-1);
       b->nb_bits_dans_buffer--;
-
-      return valeur_retour;
+      return (b->buffer >> b->nb_bits_dans_buffer) & 1;
     }
   else
     EXCEPTION_LANCE(Exception_fichier_lecture_dans_fichier_ouvert_en_ecriture);
@@ -227,6 +690,243 @@ Booleen get_bit(struct bitstream *b)
   //return 0 ; /* pour enlever un warning du compilateur */
 }
 
+/*
+ * Ecriture des "nb" bits de droite de "v" (du poids fort au poids faible)
+ * en un seul décalage de l'accumulateur.
+ * "nb" doit être inférieur ou égal à NB_BITS_MOT.
+ *
+ * Si le fichier est ouvert en lecture, on lance l'exception
+ *         Exception_fichier_ecriture_dans_fichier_ouvert_en_lecture
+ */
+
+void put_mot(struct bitstream *b, Position_Bit nb, Buffer_Bit v)
+{
+  if(!b->ecriture)
+    EXCEPTION_LANCE(Exception_fichier_ecriture_dans_fichier_ouvert_en_lecture);
+  if(nb == 0)
+    return;
+
+  if(b->nb_bits_dans_buffer + nb > NB_BITS)
+    vide_accumulateur(b);
+
+  b->buffer = (b->buffer << nb) | (v & ((Buffer_Bit)-1 >> (NB_BITS - nb)));
+  b->nb_bits_dans_buffer += nb;
+  if(b->nb_bits_dans_buffer == NB_BITS)
+    vide_accumulateur(b);
+}
+
+/*
+ * Lecture de "nb" bits (au plus NB_BITS_MOT) en un seul masquage
+ * de l'accumulateur, ils sont retournés cadrés à droite.
+ *
+ * Si il n'y a pas assez de bits dans le fichier on lance l'exception
+ *         Exception_fichier_lecture
+ *
+ * Si le fichier est ouvert en écriture, on lance l'exception
+ *         Exception_fichier_lecture_dans_fichier_ouvert_en_ecriture
+ */
+
+Buffer_Bit get_mot(struct bitstream *b, Position_Bit nb)
+{
+  if(b->ecriture)
+    EXCEPTION_LANCE(Exception_fichier_lecture_dans_fichier_ouvert_en_ecriture);
+  if(nb == 0)
+    return 0;
+
+  if(b->nb_bits_dans_buffer < nb)
+    {
+      remplit_accumulateur(b);
+      if(b->nb_bits_dans_buffer < nb)
+	EXCEPTION_LANCE(Exception_fichier_lecture);
+    }
+
+  b->nb_bits_dans_buffer -= nb;
+  return (b->buffer >> b->nb_bits_dans_buffer)
+    & ((Buffer_Bit)-1 >> (NB_BITS - nb));
+}
+
+/*
+ * Retourne les "nb" prochains bits du flot (au plus NB_BITS_MOT)
+ * cadrés à droite, SANS les consommer.
+ * Cela permet aux décodeurs de faire une recherche dans une table
+ * indexée par les prochains bits au lieu de lire bit par bit.
+ *
+ * En fin de fichier les bits manquants sont remplacés par des 0,
+ * il n'y a pas d'exception. C'est "skip_bits" qui la lance
+ * si on consomme plus de bits qu'il n'y en a.
+ */
+
+Buffer_Bit peek_bits(struct bitstream *b, Position_Bit nb)
+{
+  if(b->ecriture)
+    EXCEPTION_LANCE(Exception_fichier_lecture_dans_fichier_ouvert_en_ecriture);
+  if(nb == 0)
+    return 0;
+
+  if(b->nb_bits_dans_buffer < nb)
+    {
+      remplit_accumulateur(b);
+      if(b->nb_bits_dans_buffer < nb)
+	//Complète à droite avec des 0
+	return (b->buffer << (nb - b->nb_bits_dans_buffer))
+	  & ((Buffer_Bit)-1 >> (NB_BITS - nb));
+    }
+
+  return (b->buffer >> (b->nb_bits_dans_buffer - nb))
+    & ((Buffer_Bit)-1 >> (NB_BITS - nb));
+}
+
+/*
+ * Consomme "nb" bits (au plus NB_BITS_MOT), en général après
+ * les avoir regardés avec "peek_bits".
+ *
+ * Si il n'y a pas assez de bits dans le fichier on lance l'exception
+ *         Exception_fichier_lecture
+ */
+
+void skip_bits(struct bitstream *b, Position_Bit nb)
+{
+  if(b->ecriture)
+    EXCEPTION_LANCE(Exception_fichier_lecture_dans_fichier_ouvert_en_ecriture);
+
+  if(b->nb_bits_dans_buffer < nb)
+    {
+      remplit_accumulateur(b);
+      if(b->nb_bits_dans_buffer < nb)
+	EXCEPTION_LANCE(Exception_fichier_lecture);
+    }
+  b->nb_bits_dans_buffer -= nb;
+}
+
+/*
+ * Ecrit les "nb" octets de "octets" dans le flot.
+ * Si le flot est à une frontière d'octet, ils sont recopiés
+ * directement dans le bloc, sinon ils passent par l'accumulateur.
+ *
+ * Si le fichier est ouvert en lecture, on lance l'exception
+ *         Exception_fichier_ecriture_dans_fichier_ouvert_en_lecture
+ */
+
+void put_octets(struct bitstream *b, const unsigned char *octets, size_t nb)
+{
+  size_t n;
+
+  if(!b->ecriture)
+    EXCEPTION_LANCE(Exception_fichier_ecriture_dans_fichier_ouvert_en_lecture);
+
+  if(b->nb_bits_dans_buffer % 8)
+    {
+      while(nb--)
+	put_mot(b, 8, *octets++);
+      return;
+    }
+
+  vide_accumulateur(b);
+  while(nb)
+    {
+      if(b->position_bloc == b->taille_bloc)
+	vide_bloc(b);
+      n = b->taille_bloc - b->position_bloc;
+      if(n > nb)
+	n = nb;
+      memcpy(b->bloc + b->position_bloc, octets, n);
+      b->position_bloc += n;
+      octets += n;
+      nb -= n;
+    }
+}
+
+/*
+ * Lit "nb" octets du flot dans "octets".
+ * Comme pour l'écriture, ils sont recopiés directement
+ * depuis le bloc si le flot est à une frontière d'octet.
+ *
+ * Si il n'y a pas assez d'octets dans le fichier on lance l'exception
+ *         Exception_fichier_lecture
+ */
+
+void get_octets(struct bitstream *b, unsigned char *octets, size_t nb)
+{
+  size_t n;
+
+  if(b->ecriture)
+    EXCEPTION_LANCE(Exception_fichier_lecture_dans_fichier_ouvert_en_ecriture);
+
+  if(b->nb_bits_dans_buffer % 8)
+    {
+      while(nb--)
+	*octets++ = get_mot(b, 8);
+      return;
+    }
+
+  //Les octets déjà dans l'accumulateur sont les premiers
+  while(nb && b->nb_bits_dans_buffer)
+    {
+      *octets++ = get_mot(b, 8);
+      nb--;
+    }
+  while(nb)
+    {
+      if(b->position_bloc == b->fin_bloc && !remplit_bloc(b))
+	EXCEPTION_LANCE(Exception_fichier_lecture);
+      n = b->fin_bloc - b->position_bloc;
+      if(n > nb)
+	n = nb;
+      memcpy(octets, b->bloc + b->position_bloc, n);
+      b->position_bloc += n;
+      octets += n;
+      nb -= n;
+    }
+}
+
+/*
+ * Amène le flot à une frontière d'octet : en écriture le reste
+ * de l'octet courant est complété par des 0, en lecture il est sauté.
+ * Les "put_octets" et "get_octets" qui suivent sont des recopies.
+ */
+
+void aligne_bitstream(struct bitstream *b)
+{
+  if(b->nb_bits_dans_buffer % 8 == 0)
+    return;
+  if(b->ecriture)
+    put_mot(b, 8 - b->nb_bits_dans_buffer % 8, 0);
+  else
+    skip_bits(b, b->nb_bits_dans_buffer % 8);
+}
+
+/*
+ * Termine l'écriture d'un flot en mémoire (comme "flush_bitstream",
+ * le dernier octet est complété par des 0) et retourne le tableau
+ * contenant le flot. Son nombre d'octets est stocké dans "*taille".
+ *
+ * Le tableau reste valide jusqu'au "close_bitstream".
+ */
+
+unsigned char *bitstream_memory(struct bitstream *b, size_t *taille)
+{
+  if(b->support != Support_memoire)
+    EXIT;
+
+  flush_bitstream(b);
+  *taille = b->ecriture ? b->position_bloc : b->fin_bloc;
+  return b->bloc;
+}
+
+/*
+ * Nombre de bits écrits dans le flot depuis son ouverture.
+ * Le remplissage du dernier octet n'est compté
+ * qu'après "flush_bitstream".
+ * C'est la taille du flot de comptage.
+ */
+
+unsigned long long bitstream_nb_bits(const struct bitstream *b)
+{
+  if(!b->ecriture)
+    EXIT;
+  return 8 * (b->octets_sortis + b->position_bloc) + b->nb_bits_dans_buffer;
+}
+
 /*
  * Ne modifiez pas la fonctions suivantes
  *
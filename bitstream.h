@@ -9,22 +9,51 @@
 #include "bit.h"
 
 /*
- * Le buffer dans lequel on stocke les bits.
- * On pourrai prendre "long" mais il faudrait alors
- * déterminer si la machine est Little or Big Endian
+ * L'accumulateur dans lequel on stocke les bits.
+ * On prend un entier de 64 bits, il n'y a pas de problème
+ * de Little ou Big Endian car les octets sont extraits un par un
+ * du poids fort au poids faible avant d'aller dans le bloc.
  */
-typedef unsigned char Buffer_Bit ;
+typedef unsigned long long Buffer_Bit ;
 /*
- * Nombre de bit dans le buffer
+ * Nombre de bit dans l'accumulateur
  */
 #define NB_BITS (8*sizeof(Buffer_Bit))
+/*
+ * Taille en octets du bloc d'entrée/sortie.
+ * Le fichier n'est lu ou écrit que par blocs entiers.
+ */
+#define TAILLE_BLOC 65536
+/*
+ * Nombre maximum de bits lus ou écrits en une fois par "put_mot"/"get_mot".
+ * Il reste au plus 7 bits dans l'accumulateur après l'avoir vidé
+ * ou complété, on peut donc toujours en ajouter ou en retirer 57.
+ */
+#define NB_BITS_MOT (NB_BITS - 7)
+/*
+ * C'est aussi le nombre de bits que l'on peut regarder
+ * à l'avance avec "peek_bits" sans les consommer.
+ */
 
 struct bitstream ;
 
 struct bitstream  *open_bitstream(const char *fichier, const char* mode) ;
+struct bitstream  *open_bitstream_async(const char *fichier) ;
+struct bitstream  *open_bitstream_memory(unsigned char *buffer, size_t taille) ;
+struct bitstream  *open_bitstream_memory_read(const unsigned char *buffer, size_t taille) ;
+struct bitstream  *open_bitstream_comptage() ;
+unsigned long long bitstream_nb_bits(const struct bitstream *b) ;
+unsigned char     *bitstream_memory(struct bitstream *b, size_t *taille) ;
 void              close_bitstream(struct bitstream *b) ;
 void                      put_bit(struct bitstream *b, Booleen bit) ;
 Booleen 	          get_bit(struct bitstream *b) ;
+void                      put_mot(struct bitstream *b, Position_Bit nb, Buffer_Bit v) ;
+Buffer_Bit                get_mot(struct bitstream *b, Position_Bit nb) ;
+Buffer_Bit             peek_bits(struct bitstream *b, Position_Bit nb) ;
+void                   skip_bits(struct bitstream *b, Position_Bit nb) ;
+void                  put_octets(struct bitstream *b, const unsigned char *octets, size_t nb) ;
+void                  get_octets(struct bitstream *b, unsigned char *octets, size_t nb) ;
+void            aligne_bitstream(struct bitstream *b) ;
 
 FILE          *bitstream_get_file(const struct bitstream *b) ; /**/
 Booleen     bitstream_en_ecriture(const struct bitstream *b) ; /**/
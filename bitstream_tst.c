@@ -3,6 +3,7 @@
 #include <fcntl.h>
 
 #include "bitstream.h"
+#include "bits.h"
 #include "exception.h"
 #include "bases.h"
 
@@ -345,5 +346,629 @@ void get_bit_tst()
     }
   close_bitstream(s) ;
 
+  /*
+   * Un flot de plusieurs blocs dont la longueur n'est pas
+   * un multiple de 8 bits.
+   */
+  s = open_bitstream("xxx", "w") ;
+  for(i=0; i<3*8*TAILLE_BLOC+5; i++)
+    put_bit(s, (i*7)%11 < 5) ;
+  close_bitstream(s) ;
+
+  s = open_bitstream("xxx", "r") ;
+  for(i=0; i<3*8*TAILLE_BLOC+5; i++)
+    if ( get_bit(s) != ((i*7)%11 < 5) )
+      {
+	eprintf("Mauvais bit numéro %d dans un flot de plusieurs blocs\n", i) ;
+	return ;
+      }
+  for( ; i%8; i++)
+    if ( get_bit(s) )
+      {
+	eprintf("Le dernier octet doit être complété par des 0\n") ;
+	return ;
+      }
+  t = 0 ;
+  EXCEPTION(get_bit(s) ;
+	    ,
+	    ,
+	    case Exception_fichier_lecture:
+	    t = 1 ;
+	    break ;
+	    ) ;
+  if ( t == 0 )
+    {
+      eprintf("Le fichier de plusieurs blocs est trop long\n");
+      return ;
+    }
+  close_bitstream(s) ;
+}
+
+
+/*
+ * Longueur et valeur du mot numéro "i" pour les tests de put_mot/get_mot
+ */
+static Position_Bit longueur_mot(int i)
+{
+  return( i % (NB_BITS_MOT+1) ) ;
+}
+static Buffer_Bit valeur_mot(int i)
+{
+  return( (Buffer_Bit)i * 0x9E3779B97F4A7C15ULL ) ;
+}
+
+void put_mot_tst()
+{
+  struct bitstream *s ;
+  int i, j ;
+  Position_Bit nb ;
+
+  s = open_bitstream("xxx", "w") ;
+  for(i=0; i<10000; i++)
+    {
+      put_mot(s, longueur_mot(i), valeur_mot(i)) ;
+      put_bit(s, i&1) ;
+    }
+  close_bitstream(s) ;
+
+  s = open_bitstream("xxx", "r") ;
+  for(i=0; i<10000; i++)
+    {
+      nb = longueur_mot(i) ;
+      for(j=nb-1; j>=0; j--)
+	if ( get_bit(s) != ((valeur_mot(i) >> j) & 1) )
+	  {
+	    eprintf("put_mot(s, %d, 0x%llx) : mauvais bit %d\n"
+		    , nb, valeur_mot(i), j) ;
+	    return ;
+	  }
+      if ( get_bit(s) != (i&1) )
+	{
+	  eprintf("put_bit après put_mot(s, %d, ...) est mal placé\n", nb) ;
+	  return ;
+	}
+    }
+  close_bitstream(s) ;
+}
+
+void get_mot_tst()
+{
+  struct bitstream *s ;
+  int i ;
+  Position_Bit nb ;
+  Buffer_Bit v ;
+  volatile int t ;
+
+  put_mot_tst() ;
+
+  s = open_bitstream("xxx", "r") ;
+  for(i=0; i<10000; i++)
+    {
+      nb = longueur_mot(i) ;
+      v = get_mot(s, nb) ;
+      if ( nb && v != (valeur_mot(i) & ((Buffer_Bit)-1 >> (NB_BITS-nb))) )
+	{
+	  eprintf("get_mot(s, %d) retourne 0x%llx\n", nb, v) ;
+	  return ;
+	}
+      if ( nb == 0 && v != 0 )
+	{
+	  eprintf("get_mot(s, 0) doit retourner 0\n") ;
+	  return ;
+	}
+      if ( get_mot(s, 1) != (i&1) )
+	{
+	  eprintf("get_mot(s, 1) après get_mot(s, %d) est décalé\n", nb) ;
+	  return ;
+	}
+    }
+
+  t = 0 ;
+  EXCEPTION(get_mot(s, 8) ;
+	    ,
+	    ,
+	    case Exception_fichier_lecture:
+	    t = 1 ;
+	    break ;
+	    ) ;
+  if ( t == 0 )
+    {
+      eprintf("get_mot n'a pas lancé l'exception fin de fichier\n");
+      return ;
+    }
+  close_bitstream(s) ;
+}
+
+void open_bitstream_memory_tst()
+{
+  struct bitstream *s ;
+  unsigned char buf[3] ;
+  unsigned char *t ;
+  size_t taille ;
+  int i ;
+  volatile int e ;
+
+  s = open_bitstream_memory(buf, sizeof(buf)) ;
+  if ( !bitstream_en_ecriture(s) || bitstream_get_file(s) != NULL )
+    {
+      eprintf("Un flot mémoire est en écriture et sans fichier\n") ;
+      return ;
+    }
+  put_mot(s, 20, 0xABCDE) ;
+  t = bitstream_memory(s, &taille) ;
+  if ( t != buf || taille != 3 || buf[0] != 0xAB || buf[1] != 0xCD
+       || buf[2] != 0xE0 )
+    {
+      eprintf("Mauvais contenu du tableau fourni par l'utilisateur\n") ;
+      return ;
+    }
+  close_bitstream(s) ;
+
+  s = open_bitstream_memory(buf, sizeof(buf)) ;
+  e = 0 ;
+  EXCEPTION(for(i=0; i<8*sizeof(buf)+1; i++)
+	      put_bit(s, 1) ;
+	    close_bitstream(s) ;
+	    ,
+	    ,
+	    case Exception_fichier_ecriture:
+	    e = 1 ;
+	    break ;
+	    ) ;
+  if ( e == 0 )
+    {
+      eprintf("Pas d'exception quand le tableau fourni est trop petit\n") ;
+      return ;
+    }
+
+  s = open_bitstream_memory(NULL, 0) ;
+  for(i=0; i<100000; i++)
+    put_bits(s, 8, i) ;
+  t = bitstream_memory(s, &taille) ;
+  if ( taille != 100000 )
+    {
+      eprintf("Le tableau extensible contient %lu octets\n"
+	      , (unsigned long)taille) ;
+      return ;
+    }
+  for(i=0; i<100000; i++)
+    if ( t[i] != (i & 255) )
+      {
+	eprintf("Octet %d du tableau extensible : %d\n", i, t[i]) ;
+	return ;
+      }
+  close_bitstream(s) ;
+}
+
+void open_bitstream_memory_read_tst()
+{
+  static const unsigned char octets[] = { 0x80, 0xFF, 0x01 } ;
+  struct bitstream *s ;
+  volatile int e ;
+
+  s = open_bitstream_memory_read(octets, sizeof(octets)) ;
+  if ( bitstream_en_ecriture(s) )
+    {
+      eprintf("Un flot mémoire en lecture est en écriture\n") ;
+      return ;
+    }
+  if ( get_bit(s) != 1 || get_bits(s, 7) != 0 || get_bits(s, 9) != 0x1FE
+       || get_mot(s, 7) != 1 )
+    {
+      eprintf("Mauvaise lecture du tableau en mémoire\n") ;
+      return ;
+    }
+  e = 0 ;
+  EXCEPTION(get_bit(s) ;
+	    ,
+	    ,
+	    case Exception_fichier_lecture:
+	    e = 1 ;
+	    break ;
+	    ) ;
+  if ( e == 0 )
+    {
+      eprintf("Pas d'exception à la fin du tableau en mémoire\n") ;
+      return ;
+    }
+  close_bitstream(s) ;
+}
+
+void bitstream_memory_tst()
+{
+  struct bitstream *s, *r ;
+  unsigned char *t ;
+  size_t taille ;
+  int i ;
+
+  s = open_bitstream_memory(NULL, 1) ;
+  t = bitstream_memory(s, &taille) ;
+  if ( taille != 0 )
+    {
+      eprintf("Un flot mémoire vide a %lu octets\n", (unsigned long)taille) ;
+      return ;
+    }
+  close_bitstream(s) ;
+
+  s = open_bitstream_memory(NULL, 1) ;
+  for(i=0; i<1001; i++)
+    put_bit(s, i%3 == 0) ;
+  t = bitstream_memory(s, &taille) ;
+  if ( taille != 126 )
+    {
+      eprintf("1001 bits en mémoire font %lu octets\n", (unsigned long)taille) ;
+      return ;
+    }
+  r = open_bitstream_memory_read(t, taille) ;
+  for(i=0; i<1001; i++)
+    if ( get_bit(r) != (i%3 == 0) )
+      {
+	eprintf("Relecture du bit %d d'un flot mémoire\n", i) ;
+	return ;
+      }
+  close_bitstream(r) ;
+  close_bitstream(s) ;
+}
+
+void peek_bits_tst()
+{
+  static const unsigned char octets[] = { 0x12, 0x34, 0x56, 0x78, 0x9A } ;
+  struct bitstream *s ;
+  int i ;
+
+  s = open_bitstream_memory_read(octets, sizeof(octets)) ;
+  for(i=0; i<3; i++)
+    if ( peek_bits(s, 32) != 0x12345678 )
+      {
+	eprintf("peek_bits(s, 32) ne doit pas consommer les bits\n") ;
+	return ;
+      }
+  if ( peek_bits(s, 4) != 0x1 || peek_bits(s, 0) != 0 )
+    {
+      eprintf("peek_bits(s, 4) retourne %llx\n", peek_bits(s, 4)) ;
+      return ;
+    }
+  if ( peek_bits(s, NB_BITS_MOT) != 0x123456789AULL << (NB_BITS_MOT - 40) )
+    {
+      eprintf("La fin du fichier doit être complétée par des 0\n") ;
+      return ;
+    }
+  if ( get_bits(s, 12) != 0x123 || peek_bits(s, 12) != 0x456 )
+    {
+      eprintf("peek_bits après get_bits ne fonctionne pas\n") ;
+      return ;
+    }
+  get_bits(s, 24) ;
+  if ( peek_bits(s, 8) != 0xA0 )
+    {
+      eprintf("peek_bits sur les 4 derniers bits : %llx\n", peek_bits(s, 8)) ;
+      return ;
+    }
+  close_bitstream(s) ;
+
+  /*
+   * Sur un flot plus long que le bloc
+   */
+  s = open_bitstream("xxx", "w") ;
+  for(i=0; i<TAILLE_BLOC; i++)
+    put_bits(s, 24, i) ;
+  close_bitstream(s) ;
+  s = open_bitstream("xxx", "r") ;
+  for(i=0; i<TAILLE_BLOC; i++)
+    {
+      if ( peek_bits(s, 48) >> 24 != i )
+	{
+	  eprintf("peek_bits(s, 48) dans un flot de plusieurs blocs\n") ;
+	  return ;
+	}
+      skip_bits(s, 24) ;
+    }
+  close_bitstream(s) ;
+}
+
+void skip_bits_tst()
+{
+  static const unsigned char octets[] = { 0xF0, 0x0F } ;
+  struct bitstream *s ;
+  volatile int e ;
+
+  s = open_bitstream_memory_read(octets, sizeof(octets)) ;
+  skip_bits(s, 0) ;
+  skip_bits(s, 4) ;
+  if ( get_bits(s, 8) != 0x00 )
+    {
+      eprintf("skip_bits(s, 4) n'a pas consommé 4 bits\n") ;
+      return ;
+    }
+  skip_bits(s, 3) ;
+  e = 0 ;
+  EXCEPTION(skip_bits(s, 2) ;
+	    ,
+	    ,
+	    case Exception_fichier_lecture:
+	    e = 1 ;
+	    break ;
+	    ) ;
+  if ( e == 0 )
+    {
+      eprintf("skip_bits après la fin du fichier doit lancer l'exception\n") ;
+      return ;
+    }
+  close_bitstream(s) ;
+}
+
+void open_bitstream_async_tst()
+{
+  struct bitstream *s ;
+  int i, r ;
+
+  /*
+   * Plus de blocs qu'il n'y en a dans l'anneau
+   */
+  s = open_bitstream_async("xxx") ;
+  for(i=0; i<10*TAILLE_BLOC; i++)
+    put_mot(s, 24, i) ;
+  put_bit(s, 1) ;
+  close_bitstream(s) ;
+
+  s = open_bitstream("xxx", "r") ;
+  for(i=0; i<10*TAILLE_BLOC; i++)
+    if ( get_mot(s, 24) != (i & 0xFFFFFF) )
+      {
+	eprintf("Relecture du mot %d écrit de manière asynchrone\n", i) ;
+	return ;
+      }
+  if ( get_bit(s) != 1 )
+    {
+      eprintf("Le dernier bit asynchrone est perdu\n") ;
+      return ;
+    }
+  close_bitstream(s) ;
+
+  /*
+   * L'erreur d'écriture doit être signalée à la fermeture
+   */
+  if ( access("/dev/full", W_OK) != 0 )
+    return ;
+  r = 0 ;
+  EXCEPTION(
+	    s = open_bitstream_async("/dev/full") ;
+	    for(i=0; i<TAILLE_BLOC; i++)
+	      put_mot(s, 8, i) ;
+	    close_bitstream(s) ;
+	    ,
+	    ,
+	    case Exception_fichier_ecriture:
+	    r = 1 ;
+	    break ;
+	    ) ;
+  if ( r != 1 )
+    {
+      eprintf("Pas d'exception pour une écriture asynchrone impossible\n") ;
+      return ;
+    }
+
+  /*
+   * L'erreur est déjà connue et le dernier bloc n'est pas vide :
+   * la fermeture arrête le processus d'écriture et lance l'exception.
+   */
+  s = open_bitstream_async("/dev/full") ;
+  r = 0 ;
+  EXCEPTION(
+	    for(i=0; i<100*TAILLE_BLOC; i++)
+	      put_mot(s, 8, i) ;
+	    ,
+	    ,
+	    case Exception_fichier_ecriture:
+	    r = 1 ;
+	    break ;
+	    ) ;
+  if ( r != 1 )
+    {
+      eprintf("L'erreur d'écriture n'est pas signalée au bloc suivant\n") ;
+      return ;
+    }
+  put_mot(s, 8, 1) ;
+  r = 0 ;
+  EXCEPTION(
+	    close_bitstream(s) ;
+	    ,
+	    ,
+	    case Exception_fichier_ecriture:
+	    r = 1 ;
+	    break ;
+	    ) ;
+  if ( r != 1 )
+    {
+      eprintf("Pas d'exception à la fermeture après une erreur\n") ;
+      return ;
+    }
+}
+
+void put_octets_tst()
+{
+  struct bitstream *s ;
+  static unsigned char t[3*TAILLE_BLOC] ;
+  int i ;
+
+  for(i=0; i<sizeof(t); i++)
+    t[i] = i*7 ;
+
+  s = open_bitstream("xxx", "w") ;
+  put_octets(s, t, 3) ;		/* Aligné */
+  put_bit(s, 1) ;
+  put_octets(s, t, 5) ;		/* Non aligné */
+  put_mot(s, 7, 0) ;
+  put_octets(s, t, sizeof(t)) ;	/* Plusieurs blocs */
+  close_bitstream(s) ;
+
+  s = open_bitstream("xxx", "r") ;
+  for(i=0; i<3; i++)
+    if ( get_mot(s, 8) != t[i] )
+      {
+	eprintf("Octet aligné %d mal écrit\n", i) ;
+	return ;
+      }
+  get_bit(s) ;
+  for(i=0; i<5; i++)
+    if ( get_mot(s, 8) != t[i] )
+      {
+	eprintf("Octet non aligné %d mal écrit\n", i) ;
+	return ;
+      }
+  get_mot(s, 7) ;
+  for(i=0; i<sizeof(t); i++)
+    if ( get_mot(s, 8) != t[i] )
+      {
+	eprintf("Octet %d du grand tableau mal écrit\n", i) ;
+	return ;
+      }
+  close_bitstream(s) ;
 }
 
+void get_octets_tst()
+{
+  struct bitstream *s ;
+  static unsigned char t[3*TAILLE_BLOC], u[3*TAILLE_BLOC] ;
+  int i, r ;
+
+  for(i=0; i<sizeof(t); i++)
+    t[i] = i*13 ;
+
+  s = open_bitstream("xxx", "w") ;
+  put_mot(s, 8, 0xAB) ;
+  put_bit(s, 1) ;
+  put_octets(s, t, 5) ;
+  put_mot(s, 7, 0) ;
+  put_octets(s, t, sizeof(t)) ;
+  close_bitstream(s) ;
+
+  s = open_bitstream("xxx", "r") ;
+  get_octets(s, u, 1) ;		/* Aligné, pris dans l'accumulateur */
+  get_bit(s) ;
+  get_octets(s, u+1, 5) ;	/* Non aligné */
+  if ( u[0] != 0xAB || memcmp(u+1, t, 5) )
+    {
+      eprintf("Mauvaise lecture des premiers octets\n") ;
+      return ;
+    }
+  get_mot(s, 7) ;
+  get_octets(s, u, sizeof(u)) ;
+  if ( memcmp(u, t, sizeof(t)) )
+    {
+      eprintf("Mauvaise lecture du grand tableau\n") ;
+      return ;
+    }
+  r = 0 ;
+  EXCEPTION(get_octets(s, u, 1) ;
+	    ,
+	    ,
+	    case Exception_fichier_lecture:
+	    r = 1 ;
+	    break ;
+	    ) ;
+  if ( r != 1 )
+    {
+      eprintf("Pas d'exception en lisant après la fin\n") ;
+      return ;
+    }
+  close_bitstream(s) ;
+}
+
+void aligne_bitstream_tst()
+{
+  struct bitstream *s ;
+  int i ;
+
+  s = open_bitstream("xxx", "w") ;
+  aligne_bitstream(s) ;		/* Déjà aligné : rien */
+  put_mot(s, 3, 5) ;
+  aligne_bitstream(s) ;
+  if ( bitstream_nb_bits_dans_buffer(s) % 8 )
+    {
+      eprintf("Le flot en écriture n'est pas aligné\n") ;
+      return ;
+    }
+  put_mot(s, 8, 0xC3) ;
+  put_mot(s, 13, 0x1234) ;
+  aligne_bitstream(s) ;
+  put_mot(s, 8, 0x5A) ;
+  close_bitstream(s) ;
+
+  s = open_bitstream("xxx", "r") ;
+  if ( peek_bits(s, 8) != 0xA0 )
+    {
+      eprintf("Le remplissage doit être fait de 0\n") ;
+      return ;
+    }
+  i = get_mot(s, 3) ;
+  aligne_bitstream(s) ;
+  if ( i != 5 || get_mot(s, 8) != 0xC3 )
+    {
+      eprintf("Mauvaise relecture après le premier alignement\n") ;
+      return ;
+    }
+  get_mot(s, 13) ;
+  aligne_bitstream(s) ;
+  if ( get_mot(s, 8) != 0x5A )
+    {
+      eprintf("Mauvaise relecture après le second alignement\n") ;
+      return ;
+    }
+  close_bitstream(s) ;
+}
+
+void open_bitstream_comptage_tst()
+{
+  struct bitstream *s ;
+  int i ;
+
+  s = open_bitstream_comptage() ;
+  if ( !bitstream_en_ecriture(s) || bitstream_get_file(s) != NULL )
+    {
+      eprintf("Le flot de comptage est en écriture et sans fichier\n") ;
+      return ;
+    }
+  for(i=0; i<100000; i++)
+    put_mot(s, 13, i) ;
+  put_bit(s, 1) ;
+  if ( bitstream_nb_bits(s) != 1300001 )
+    {
+      eprintf("%llu bits comptés au lieu de 1300001\n", bitstream_nb_bits(s)) ;
+      return ;
+    }
+  close_bitstream(s) ;
+}
+
+void bitstream_nb_bits_tst()
+{
+  struct bitstream *s, *m ;
+  size_t taille ;
+  int i ;
+
+  /*
+   * Le même flot en mémoire, dans un fichier et compté
+   */
+  m = open_bitstream_memory(NULL, 1) ;
+  s = open_bitstream("xxx", "w") ;
+  for(i=0; i<3*TAILLE_BLOC; i++)
+    {
+      put_mot(m, i%20, i) ;
+      put_mot(s, i%20, i) ;
+    }
+  if ( bitstream_nb_bits(m) != bitstream_nb_bits(s) )
+    {
+      eprintf("Mémoire %llu bits, fichier %llu bits\n"
+	      , bitstream_nb_bits(m), bitstream_nb_bits(s)) ;
+      return ;
+    }
+  bitstream_memory(m, &taille) ;
+  if ( bitstream_nb_bits(m) != 8*taille )
+    {
+      eprintf("Après vidage il y a %llu bits pour %lu octets\n"
+	      , bitstream_nb_bits(m), (unsigned long)taille) ;
+      return ;
+    }
+  close_bitstream(m) ;
+  close_bitstream(s) ;
+}
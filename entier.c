@@ -1,4 +1,3 @@
-#include "bits.h"
 #include "entier.h"
 
 /*
@@ -35,25 +34,49 @@
  *
  */
 
-static char *prefixes[] = { "00", "010", "011", "1000", "1001", "1010", "1011",
-			    "11000", "11001", "11010", "11011", "11100",
-			    "11101", "11110", "111110", "111111" } ;
+/*
+ * Les préfixes du tableau ci-dessus, déjà sous forme binaire,
+ * indicés par le nombre de bits de l'entier.
+ */
 
-void put_entier(struct bitstream *b, unsigned int f)
+static const struct
+{
+  unsigned char code ;
+  unsigned char longueur ;
+} prefixes[] = { {0x00, 2}, {0x02, 3}, {0x03, 3}
+		 , {0x08, 4}, {0x09, 4}, {0x0A, 4}, {0x0B, 4}
+		 , {0x18, 5}, {0x19, 5}, {0x1A, 5}, {0x1B, 5}, {0x1C, 5}
+		 , {0x1D, 5}, {0x1E, 5}, {0x3E, 6}, {0x3F, 6} } ;
+
+/*
+ * Calcule le code complet (préfixe puis suffixe) de l'entier
+ * et sa longueur pour l'écrire en un seul "put_mot".
+ */
+
+static Buffer_Bit code_entier(unsigned int f, Position_Bit *longueur)
 {
-  int i;
   int nb_bits = nb_bits_utile(f);
 
-  //Je put le prefixe
-  if(nb_bits > TAILLE(prefixes))
+  if(nb_bits >= TAILLE(prefixes))
     EXIT;
 
-  put_bit_string(b, prefixes[nb_bits]);
-  for(i = 0; i<nb_bits-1; i++)
+  //Le suffixe est l'entier sans son premier bit à 1
+  if(nb_bits > 1)
     {
-      //Je put le reste en enlevant le premier bit à 1
-      put_bit(b, prend_bit(f, nb_bits-2-i));
+      *longueur = prefixes[nb_bits].longueur + nb_bits - 1;
+      return ((Buffer_Bit)prefixes[nb_bits].code << (nb_bits - 1))
+	| (f & (pow2(nb_bits - 1) - 1));
     }
+  *longueur = prefixes[nb_bits].longueur;
+  return prefixes[nb_bits].code;
+}
+
+void put_entier(struct bitstream *b, unsigned int f)
+{
+  Position_Bit longueur;
+  Buffer_Bit code = code_entier(f, &longueur);
+
+  put_mot(b, longueur, code);
 }
 
 /*
@@ -62,59 +85,73 @@ void put_entier(struct bitstream *b, unsigned int f)
  * Un implémentation propre, extensible serait d'utiliser
  * un arbre binaire comme pour le décodage d'Huffman.
  * Ou bien parcourir l'arbre des états 8 bits par 8 bits (voir le cours)
- * Mais je ne vous le demande pas
+ *
+ * On regarde les NB_BITS_TABLE_ENTIER prochains bits du flot
+ * et une table indexée par ces bits donne directement :
+ *    - la longueur du code à consommer,
+ *    - la valeur si tout le code (préfixe et suffixe) tient dans la table,
+ *    - sinon le bit de poids fort de la valeur et le nombre de bits
+ *      de suffixe qui restent à lire.
+ * Le plus long préfixe (6 bits) tient toujours dans la table.
  */
 
-unsigned int get_entier(struct bitstream *b)
+#define NB_BITS_TABLE_ENTIER 12
+
+static struct
 {
-  //Faire un tableau pour stocker le prefixe
-  char tab[50];
-  int indice_tab = 0;
-  int indice_prefixe;
-  int res = 0;
-  int parcour_bits;
-  Booleen lu;
-  Booleen prefixe_trouve = 0;
-
-  while(prefixe_trouve == 0)
-    {
-      //Je lis mon bit et le stocke dans le tab
-      lu = get_bit(b);
-      if(lu)
-	tab[indice_tab] = '1';
-      else
-	tab[indice_tab] = '0';
-		
-      tab[indice_tab+1] = '\0';	
-
-      //Pour tous les prefixes
-      for(indice_prefixe = 0; indice_prefixe < 16; indice_prefixe++)
-	{
-	  //On test si c'est égal à ce qu'on à déjà récupéré
-	  if(strcmp(prefixes[indice_prefixe],tab) == 0)
-	    {
-	      prefixe_trouve = 1;
-	      break;
-	    }
-	}
-      indice_tab++;
-    }
+  unsigned char  longueur ;	/* Nombre de bits à consommer */
+  unsigned char  suffixe ;	/* Nombre de bits restant à lire */
+  unsigned short valeur ;	/* Valeur ou son bit de poids fort */
+} table_entier[1 << NB_BITS_TABLE_ENTIER] ;
+
+static void initialise_table_entier()
+{
+  int i, categorie, longueur_prefixe, nb_suffixe ;
+
+  for(i=0; i<TAILLE(table_entier); i++)
+    for(categorie=0; categorie<TAILLE(prefixes); categorie++)
+      {
+	longueur_prefixe = prefixes[categorie].longueur ;
+	if ( (i >> (NB_BITS_TABLE_ENTIER - longueur_prefixe))
+	     != prefixes[categorie].code )
+	  continue ;
+
+	nb_suffixe = categorie > 1 ? categorie - 1 : 0 ;
+	if ( longueur_prefixe + nb_suffixe <= NB_BITS_TABLE_ENTIER )
+	  {
+	    table_entier[i].longueur = longueur_prefixe + nb_suffixe ;
+	    table_entier[i].suffixe = 0 ;
+	    table_entier[i].valeur = categorie == 0 ? 0
+	      : pow2(categorie-1)
+	      | ((i >> (NB_BITS_TABLE_ENTIER - table_entier[i].longueur))
+		 & (pow2(nb_suffixe) - 1)) ;
+	  }
+	else
+	  {
+	    table_entier[i].longueur = longueur_prefixe ;
+	    table_entier[i].suffixe = nb_suffixe ;
+	    table_entier[i].valeur = pow2(categorie-1) ;
+	  }
+	break ;
+      }
+}
 
-  //Les deux premier cas spéciaux 0 et 1
-  if(indice_prefixe == 0)	
-    return 0;
-  if(indice_prefixe == 1)
-    return 1;
+unsigned int get_entier(struct bitstream *b)
+{
+  static Booleen table_initialisee = Faux ;
+  int i ;
 
-  //Pour les autres cas
-  res = pose_bit(res, indice_prefixe-1, 1);
-  parcour_bits = indice_prefixe-2;
-  while(parcour_bits>=0)
+  if ( !table_initialisee )
     {
-      res = pose_bit(res, parcour_bits, get_bit(b));
-      parcour_bits--;		
+      initialise_table_entier() ;
+      table_initialisee = Vrai ;
     }
-  return res ; /* pour enlever un warning du compilateur */
+
+  i = peek_bits(b, NB_BITS_TABLE_ENTIER) ;
+  skip_bits(b, table_entier[i].longueur) ;
+  if ( table_entier[i].suffixe == 0 )
+    return table_entier[i].valeur ;
+  return table_entier[i].valeur | get_mot(b, table_entier[i].suffixe) ;
 }
 
 /*
@@ -134,10 +171,19 @@ unsigned int get_entier(struct bitstream *b)
 
 void put_entier_signe(struct bitstream *b, int i)
 {
+  Position_Bit longueur;
+  Buffer_Bit code;
+
+  //Le bit de signe est ajouté devant le code de l'entier
   if(i < 0)
-    { put_bit(b, 1) ; put_entier(b, -(i+1)); }
+    {
+      code = code_entier(-(i+1), &longueur);
+      code |= (Buffer_Bit)1 << longueur;
+    }
   else
-    { put_bit(b, 0) ; put_entier(b, i)     ; }
+    code = code_entier(i, &longueur);
+
+  put_mot(b, longueur + 1, code);
 }
 
 /*
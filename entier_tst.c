@@ -1,4 +1,5 @@
 #include "entier.h"
+#include "bits.h"
 #include "bases.h"
 
 static struct
@@ -82,6 +83,30 @@ void get_entier_tst()
 	  }
     }
   close_bitstream(bs) ;
+
+  /*
+   * Tous les entiers, chacun précédé d'un décalage différent
+   * pour que les codes soient à toutes les positions dans l'octet.
+   */
+  bs = open_bitstream("xxx", "w") ;
+  for(i=0; i<32768; i++)
+    {
+      put_bits(bs, i%3, 0) ;
+      put_entier(bs, i) ;
+    }
+  close_bitstream(bs) ;
+  bs = open_bitstream("xxx", "r") ;
+  for(i=0; i<32768; i++)
+    {
+      get_bits(bs, i%3) ;
+      j = get_entier(bs) ;
+      if ( j != i )
+	{
+	  eprintf("Lecture de l'entier %d, je recois %d\n", i, j) ;
+	  return ;
+	}
+    }
+  close_bitstream(bs) ;
 }
 
 void put_entier_signe_tst()
@@ -1,4 +1,5 @@
 #include <string.h>
+#include <time.h>
 #include "bases.h"
 #include "dct.h"
 #include "psycho.h"
@@ -10,6 +11,7 @@
 #include "intstream.h"
 #include "bitstream.h"
 #include "exception.h"
+#include "bits.h"
 #include "ondelette.h"
 
 #define LARG 8 /* 8 blocs à afficher */
@@ -25,6 +27,10 @@ struct parametres
   float qualite ;
   int shannon ;
   int saute_entete ;
+  int separe ;
+  int periode ;
+  int vieillissement ;
+  int asynchrone ;
 } ;
 
 void fread_safe(void *ptr, size_t size, size_t nr, FILE *f)
@@ -149,86 +155,339 @@ void saute_entete(struct parametres *p)
     }
 }
 
-void filtre_rle(struct parametres *p)
+/*
+ * Le type des deux "intstream" de "rle" et "rleinv" suivant SHANNON :
+ *    0 : codes statiques de "entier.c" (entiers de 0 à 32767)
+ *    1 : Shannon-Fano dynamique
+ *    2 : Golomb-Rice adaptatif (sans limite)
+ *    3 : octets (stream-vbyte), décodage très rapide, toujours SEPARE
+ *    4 : Huffman canonique en deux passes par trame, toujours SEPARE
+ *    5 : codage par intervalles adaptatif (arithmétique), toujours SEPARE
+ *    6 : rANS en deux passes par trame, toujours SEPARE
+ *    7 : Huffman adaptatif de Vitter
+ * De 3 à 6 les entiers sont codés par trame, il faut donc SEPARE.
+ */
+
+static enum intstream_type type_rle(struct parametres *p, Booleen signe)
+{
+  switch(p->shannon)
+    {
+    case 0:
+      return signe ? Entier_Signe : Entier ;
+    case 1:
+      return Shannon_fano ;
+    case 2:
+      return signe ? Golomb_Signe : Golomb ;
+    case 3:
+      return signe ? Vbyte_Signe : Vbyte ;
+    case 4:
+      return signe ? Huffman_canonique_Signe : Huffman_canonique ;
+    case 5:
+      return Intervalle ;
+    case 6:
+      return signe ? Rans_Signe : Rans ;
+    case 7:
+      return Vitter ;
+    default:
+      fprintf(stderr, "SHANNON=%d inconnu\n", p->shannon) ;
+      EXIT ;
+    }
+}
+
+/*
+ * Si PERIODE est non nulle, le Shannon-Fano est semi-statique :
+ * ses codes sont reconstruits tous les PERIODE événements.
+ * Si VIEILLISSEMENT est non nul, les occurrences sont divisées par deux
+ * quand leur total le dépasse.
+ * Avec SHANNON=5 c'est le seuil des fréquences du codage par intervalles.
+ * Seul le codeur les utilise : le décodeur les lit dans le flot.
+ */
+
+static struct shannon_fano *ouvre_shannon_fano(struct parametres *p)
 {
-  float *entree ;
-  struct intstream *entier, *entier_signe ;
-  struct bitstream *bs ;
   struct shannon_fano *sf ;
 
-  if ( p->saute_entete )
-    p->nbe *= p->nbe ;
+  sf = p->periode ? open_shannon_fano_semi_statique(p->periode)
+    : open_shannon_fano() ;
+  vieillissement_shannon_fano(sf, p->vieillissement) ;
+  return sf ;
+}
 
-  saute_entete(p) ;
-  bs = open_bitstream("-", "w") ;
-  if ( p->shannon )
+/*
+ * Ouvre les deux "intstream" de "rle" et "rleinv".
+ *
+ * Avec SEPARE chacun a son propre flot de bits (et son propre modèle
+ * de Shannon-Fano), les flots sont écrits par trames de NB_BLOCS_TRAME
+ * blocs au plus. Sinon ils sont intercalés dans "bs".
+ */
+
+#define NB_BLOCS_TRAME 1024
+
+static void ouvre_intstreams_rle(struct parametres *p, struct bitstream *bs
+				 , const char *mode, struct intstream **is
+				 , struct shannon_fano **sf)
+{
+  sf[0] = sf[1] = NULL ;
+  if ( intstream_type_par_bloc(type_rle(p, Faux)) )
+    p->separe = 1 ;
+  if ( type_rle(p, Faux) == Shannon_fano )
+    {
+      sf[0] = ouvre_shannon_fano(p) ;
+      sf[1] = p->separe ? ouvre_shannon_fano(p) : sf[0] ;
+    }
+  if ( p->separe )
     {
-      sf = open_shannon_fano() ;
-      entier = open_intstream(bs, Shannon_fano, sf) ;
-      entier_signe = open_intstream(bs, Shannon_fano, sf) ;
+      is[0] = open_intstream_separe(mode, type_rle(p, Faux), sf[0]) ;
+      is[1] = open_intstream_separe(mode, type_rle(p, Vrai), sf[1]) ;
     }
   else
     {
-      entier = open_intstream(bs, Entier, NULL) ;
-      entier_signe = open_intstream(bs, Entier_Signe, NULL) ;
+      is[0] = open_intstream(bs, type_rle(p, Faux), sf[0]) ;
+      is[1] = open_intstream(bs, type_rle(p, Vrai), sf[1]) ;
     }
+  if ( p->vieillissement )
+    {
+      vieillissement_intstream(is[0], p->vieillissement) ;
+      vieillissement_intstream(is[1], p->vieillissement) ;
+    }
+}
+
+static void ferme_intstreams_rle(struct intstream **is
+				 , struct shannon_fano **sf)
+{
+  close_intstream(is[0]) ;
+  close_intstream(is[1]) ;
+  if ( sf[1] != sf[0] )
+    close_shannon_fano(sf[1]) ;
+  if ( sf[0] )
+    close_shannon_fano(sf[0]) ;
+}
+
+/*
+ * Une trame commence par un bit à 1 et son nombre de blocs.
+ */
+
+static void ecrit_trame_rle(struct bitstream *bs, struct intstream **is
+			    , int nb_blocs)
+{
+  put_bit(bs, Vrai) ;
+  put_bits(bs, 32, nb_blocs) ;
+  ecrit_trame_intstreams(bs, is, 2) ;
+}
+
+/*
+ * Le codage de "rle" de "entree" dans "bs",
+ * qui peut être un flot de comptage.
+ */
+
+static void codage_rle(struct parametres *p, FILE *f, struct bitstream *bs)
+{
+  float *entree ;
+  struct intstream *is[2] ;
+  struct shannon_fano *sf[2] ;
+  int nb_blocs ;
+
+  ouvre_intstreams_rle(p, bs, "w", is, sf) ;
 
   ALLOUER(entree, p->nbe) ;
 
-  while( fread((char*)entree,1,p->nbe*sizeof(*entree),stdin) == p->nbe*sizeof(*entree) )
+  /*
+   * Chaque bloc (ou chaque trame avec SEPARE) est précédé d'un bit à 1,
+   * la fin du flux est marquée par un bit à 0 : le décodeur s'arrête
+   * sans avoir à lire au delà et les bits de remplissage du dernier
+   * octet ne sont pas décodés.
+   */
+  nb_blocs = 0 ;
+  while( fread((char*)entree,1,p->nbe*sizeof(*entree),f) == p->nbe*sizeof(*entree) )
     {
-      compresse(entier, entier_signe, p->nbe, entree) ;
+      if ( !p->separe )
+	put_bit(bs, Vrai) ;
+      compresse(is[0], is[1], p->nbe, entree) ;
+      if ( p->separe && ++nb_blocs == NB_BLOCS_TRAME )
+	{
+	  ecrit_trame_rle(bs, is, nb_blocs) ;
+	  nb_blocs = 0 ;
+	}
     } 
+  if ( nb_blocs )
+    ecrit_trame_rle(bs, is, nb_blocs) ;
+  put_bit(bs, Faux) ;
   free(entree) ;
-  close_intstream(entier) ;
-  close_intstream(entier_signe) ;
+  ferme_intstreams_rle(is, sf) ;
+}
+
+/*
+ * Avec ASYNCHRONE non nul, la sortie est écrite par un second thread
+ * pendant le codage des blocs suivants.
+ */
+
+void filtre_rle(struct parametres *p)
+{
+  struct bitstream *bs ;
+
+  if ( p->saute_entete )
+    p->nbe *= p->nbe ;
+
+  saute_entete(p) ;
+  bs = p->asynchrone ? open_bitstream_async("-") : open_bitstream("-", "w") ;
+  codage_rle(p, stdin, bs) ;
   close_bitstream(bs) ;
 }
 
-void filtre_rleinv(struct parametres *p)
+/*
+ * Affiche la taille en octets qu'aurait la sortie de "rle"
+ * avec les mêmes paramètres, sans rien écrire.
+ */
+
+void filtre_rle_taille(struct parametres *p)
+{
+  struct bitstream *bs ;
+  int buf[2] ;
+  unsigned long long taille ;
+
+  if ( p->saute_entete )
+    {
+      p->nbe *= p->nbe ;
+      fread_safe((char*)buf, 1, sizeof(buf), stdin ) ;
+    }
+
+  bs = open_bitstream_comptage() ;
+  codage_rle(p, stdin, bs) ;
+  taille = (bitstream_nb_bits(bs) + 7) / 8 ;
+  if ( p->saute_entete )
+    taille += sizeof(buf) ;
+  printf("%llu\n", taille) ;
+  close_bitstream(bs) ;
+}
+
+/*
+ * Le décodage de "rleinv" de "bs" dans "f" (rien n'est écrit si NULL)
+ */
+
+static void decodage_rle(struct parametres *p, struct bitstream *bs, FILE *f)
 {
   float *entree ;
-  struct intstream *entier, *entier_signe ;
+  struct intstream *is[2] ;
+  struct shannon_fano *sf[2] ;
+  int nb_blocs ;
+
+  ouvre_intstreams_rle(p, bs, "r", is, sf) ;
+ 
+  ALLOUER(entree, p->nbe) ;
+  while( get_bit(bs) )
+    {
+      if ( p->separe )
+	{
+	  nb_blocs = get_bits(bs, 32) ;
+	  lit_trame_intstreams(bs, is, 2) ;
+	}
+      else
+	nb_blocs = 1 ;
+      while( nb_blocs-- )
+	{
+	  decompresse(is[0], is[1], p->nbe, entree) ;
+	  if ( f )
+	    fwrite(entree, p->nbe, sizeof(*entree), f) ;
+	}
+    }
+
+  free(entree) ;
+  ferme_intstreams_rle(is, sf) ;
+}
+
+void filtre_rleinv(struct parametres *p)
+{
   struct bitstream *bs ;
-  struct shannon_fano *sf ;
 
   if ( p->saute_entete )
     p->nbe *= p->nbe ;
 
   saute_entete(p) ;
   bs = open_bitstream("-", "r") ;
-  if ( p->shannon )
+  /*
+   * Un flux vide ou tronqué (sans bit de fin) lève une exception
+   * en lecture : on s'arrête proprement avec une erreur.
+   */
+  EXCEPTION(decodage_rle(p, bs, stdout)
+	    ,
+	    fflush(stdout) ;
+	    fprintf(stderr, "rleinv : flux tronqué ou invalide\n") ;
+	    exit(1) ;
+	    ,
+	    ) ;
+  close_bitstream(bs) ;
+}
+
+/*
+ * Banc d'essai : pour chaque valeur de SHANNON, taille de la sortie
+ * de "rle" et vitesse de codage et de décodage en Mo/s
+ * (mégaoctets de l'entrée de "rle" par seconde).
+ * L'entrée est lue une fois en mémoire, les flots sont en mémoire.
+ */
+
+#define NB_SHANNON 8
+
+static double secondes()
+{
+  struct timespec t ;
+
+  clock_gettime(CLOCK_MONOTONIC, &t) ;
+  return t.tv_sec + t.tv_nsec / 1e9 ;
+}
+
+void filtre_banc(struct parametres *p)
+{
+  struct parametres q ;
+  struct bitstream *bs, *lu ;
+  unsigned char *donnees, *sortie ;
+  size_t taille, taille_sortie ;
+  int buf[2], n ;
+  double debut, codage, decodage ;
+  FILE *f ;
+
+  if ( p->saute_entete )
     {
-      sf = open_shannon_fano() ;
-      entier = open_intstream(bs, Shannon_fano, sf) ;
-      entier_signe = open_intstream(bs, Shannon_fano, sf) ;
+      p->nbe *= p->nbe ;
+      fread_safe((char*)buf, 1, sizeof(buf), stdin ) ;
     }
-  else
+  taille = 0 ;
+  donnees = NULL ;
+  do
     {
-      entier = open_intstream(bs, Entier, NULL) ;
-      entier_signe = open_intstream(bs, Entier_Signe, NULL) ;
+      donnees = realloc(donnees, taille + TAILLE_BLOC) ;
+      if ( donnees == NULL )
+	EXIT ;
+      n = fread(donnees + taille, 1, TAILLE_BLOC, stdin) ;
+      taille += n ;
     }
- 
-  ALLOUER(entree, p->nbe) ;
-  EXCEPTION(
-  {
-    for(;;)
-      {
-	decompresse(entier, entier_signe, p->nbe, entree) ;
-	fwrite(entree, p->nbe, sizeof(*entree), stdout) ;
-      }
-  }
-    ,
-	,
-	case Exception_fichier_lecture:
-	  break ;
-
-  ) ;
+  while( n > 0 ) ;
+  if ( taille == 0 )
+    EXIT ;
 
-  free(entree) ;
-  close_intstream(entier) ;
-  close_intstream(entier_signe) ;
-  close_bitstream(bs) ;
+  printf("SHANNON   octets   codage Mo/s   décodage Mo/s\n") ;
+  for(q = *p, q.shannon = 0; q.shannon < NB_SHANNON; q.shannon++)
+    {
+      q.separe = p->separe ;
+      f = fmemopen(donnees, taille, "r") ;
+      bs = open_bitstream_memory(NULL, 0) ;
+      debut = secondes() ;
+      codage_rle(&q, f, bs) ;
+      sortie = bitstream_memory(bs, &taille_sortie) ;
+      codage = secondes() - debut ;
+      fclose(f) ;
+
+      lu = open_bitstream_memory_read(sortie, taille_sortie) ;
+      debut = secondes() ;
+      decodage_rle(&q, lu, NULL) ;
+      decodage = secondes() - debut ;
+      close_bitstream(lu) ;
+      close_bitstream(bs) ;
+
+      printf("%7d %8lu %13.1f %15.1f\n", q.shannon
+	     , (unsigned long)taille_sortie
+	     , taille / codage / 1e6, taille / decodage / 1e6) ;
+    }
+  free(donnees) ;
 }
 
 void filtre_psycho(struct parametres *p)
@@ -255,22 +514,33 @@ void filtre_imagedct(struct parametres *p)
   compresse_image(p->nbe, image, stdout) ;
 }
 
+/*
+ * Les octets de l'entrée standard sont lus par paquets
+ * et chaque paquet est codé d'un coup.
+ */
+
+#define NB_OCTETS_SF 4096
+
 void filtre_shannon_fano_8(struct parametres *p)
 {
   struct shannon_fano *sf ;
   struct bitstream *bs ;
-  int c ;
+  struct intstream *is ;
+  unsigned char buf[NB_OCTETS_SF] ;
+  int v[NB_OCTETS_SF] ;
+  int i, n ;
 
-  sf = open_shannon_fano() ;
+  sf = ouvre_shannon_fano(p) ;
   bs = open_bitstream("-", "w") ;
+  is = open_intstream(bs, Shannon_fano, sf) ;
 
-  for(;;)
+  while( (n = fread(buf, 1, sizeof(buf), stdin)) > 0 )
     {
-      c = getchar() ;
-      if ( c == -1 )
-	break ;
-      put_entier_shannon_fano(bs, sf, c) ;
+      for(i=0; i<n; i++)
+	v[i] = buf[i] ;
+      put_entiers_intstream(is, v, n) ;
     }
+  close_intstream(is) ;
   close_bitstream(bs) ;
   close_shannon_fano(sf) ;  
 }
@@ -279,21 +549,23 @@ void filtre_shannon_fano_16(struct parametres *p)
 {
   struct shannon_fano *sf ;
   struct bitstream *bs ;
-  int c, d ;
+  struct intstream *is ;
+  unsigned char buf[NB_OCTETS_SF] ;
+  int v[NB_OCTETS_SF/2] ;
+  int i, n ;
 
-  sf = open_shannon_fano() ;
+  sf = ouvre_shannon_fano(p) ;
   bs = open_bitstream("-", "w") ;
+  is = open_intstream(bs, Shannon_fano, sf) ;
 
-  for(;;)
+  //Un octet isolé à la fin est ignoré
+  while( (n = fread(buf, 2, sizeof(buf)/2, stdin)) > 0 )
     {
-      c = getchar() ;
-      if ( c == -1 )
-	break ;
-      d = getchar() ;
-      if ( d == -1 )
-	break ;
-      put_entier_shannon_fano(bs, sf, c*256+d) ;
+      for(i=0; i<n; i++)
+	v[i] = buf[2*i]*256 + buf[2*i+1] ;
+      put_entiers_intstream(is, v, n) ;
     }
+  close_intstream(is) ;
   close_bitstream(bs) ;
   close_shannon_fano(sf) ;  
 }
@@ -442,6 +714,8 @@ void filtres(int argc, char **argv)
     { "psycho"      ,  filtre_psycho         , 0, 128, 33, 0.5, 0},
     { "rle"         ,  filtre_rle            , 0, 128, 33, 10 , 0},
     { "rleinv"      ,  filtre_rleinv         , 0, 128, 33, 10 , 0},
+    { "rle_taille"  ,  filtre_rle_taille     , 0, 128, 33, 10 , 0},
+    { "banc"        ,  filtre_banc           , 0, 128, 33, 10 , 0},
     { "imagedct"    ,  filtre_imagedct       , 0,   8, 33, 10 , 0},
     { "imagedctinv" ,  filtre_imagedctinv    , 0,   8, 33, 10 , 0},
     { "quantif"     ,  filtre_quantif        , 0,   8, 33, 10 , 0},
@@ -486,6 +760,18 @@ void filtres(int argc, char **argv)
 	if ( getenv("SAUTE_ENTETE") )
 	  pp.saute_entete = atof(getenv("SAUTE_ENTETE")) ;
 
+	if ( getenv("SEPARE") )
+	  pp.separe = atoi(getenv("SEPARE")) ;
+
+	if ( getenv("PERIODE") )
+	  pp.periode = atoi(getenv("PERIODE")) ;
+
+	if ( getenv("VIEILLISSEMENT") )
+	  pp.vieillissement = atoi(getenv("VIEILLISSEMENT")) ;
+
+	if ( getenv("ASYNCHRONE") )
+	  pp.asynchrone = atoi(getenv("ASYNCHRONE")) ;
+
 	(*p[i].fct)(&pp) ;
 	exit(0) ;
       }
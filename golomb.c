@@ -0,0 +1,140 @@
+#include "golomb.h"
+#include "exception.h"
+
+/*
+ * Codage de Golomb-Rice adaptatif (comme dans LOCO-I/JPEG-LS).
+ *
+ * L'entier "v" est coupé en deux avec un paramètre "k" :
+ *    - le quotient q = v >> k est écrit en unaire : q bits à 0 puis un 1,
+ *    - le reste, les k bits de droite de "v", est écrit tel quel.
+ *
+ * "k" est choisi pour que 2^k soit proche de la moyenne des entiers
+ * déjà codés : le codeur et le décodeur le calculent de la même
+ * manière, il n'est donc pas transmis.
+ *
+ * Pour ne pas avoir de code trop long sur un grand entier,
+ * si le quotient atteint LIMITE_UNAIRE on écrit LIMITE_UNAIRE bits à 0,
+ * un 1, puis l'entier en Exp-Golomb : son nombre de bits moins un
+ * sur 5 bits et ses bits sans le premier 1.
+ * Il n'y a donc pas de limite sur la valeur de l'entier.
+ *
+ * Le décodage regarde les LIMITE_UNAIRE+1 prochains bits,
+ * le nombre de zéros à gauche donne directement le quotient.
+ */
+
+#define LIMITE_UNAIRE 24
+
+/*
+ * Au bout de NB_MAX_MOYENNE entiers la somme et le nombre
+ * sont divisés par deux pour suivre les variations.
+ */
+#define NB_MAX_MOYENNE 64
+
+struct golomb
+{
+  unsigned long somme ;		/* Somme des derniers entiers codés */
+  unsigned int  nb ;		/* Leur nombre */
+  int           k ;		/* Nombre de bits du reste */
+} ;
+
+struct golomb* open_golomb()
+{
+  struct golomb *g ;
+
+  ALLOUER(g, 1) ;
+  g->somme = 0 ;
+  g->nb = 1 ;
+  g->k = 0 ;
+  return g ;
+}
+
+void close_golomb(struct golomb *g)
+{
+  free(g) ;
+}
+
+/*
+ * Prise en compte de l'entier codé pour calculer le prochain "k" :
+ * le plus petit tel que nb * 2^k >= somme (au plus 30).
+ */
+
+static void mise_a_jour(struct golomb *g, unsigned int v)
+{
+  g->somme += v ;
+  if ( ++g->nb == NB_MAX_MOYENNE )
+    {
+      g->somme >>= 1 ;
+      g->nb >>= 1 ;
+    }
+  for(g->k = 0; ((unsigned long)g->nb << g->k) < g->somme && g->k < 30; g->k++)
+    ;
+}
+
+void put_entier_golomb(struct bitstream *bs, struct golomb *g, unsigned int v)
+{
+  unsigned int q = v >> g->k ;
+  int nb ;
+
+  if ( q < LIMITE_UNAIRE )
+    {
+      //Le 1 de fin du quotient et le reste en un seul mot
+      put_mot(bs, q, 0) ;
+      put_mot(bs, g->k + 1, pow2(g->k) | v) ;
+    }
+  else
+    {
+      put_mot(bs, LIMITE_UNAIRE + 1, 1) ;
+      nb = nb_bits_utile(v) - 1 ;
+      put_mot(bs, 5, nb) ;
+      put_mot(bs, nb, v) ;
+    }
+  mise_a_jour(g, v) ;
+}
+
+unsigned int get_entier_golomb(struct bitstream *bs, struct golomb *g)
+{
+  unsigned int q, v ;
+  int nb ;
+
+  q = LIMITE_UNAIRE + 1 - nb_bits_utile(peek_bits(bs, LIMITE_UNAIRE + 1)) ;
+  if ( q > LIMITE_UNAIRE )
+    //Que des 0 : flot invalide ou terminé
+    EXCEPTION_LANCE(Exception_fichier_lecture) ;
+  skip_bits(bs, q + 1) ;
+
+  if ( q < LIMITE_UNAIRE )
+    v = (q << g->k) | get_mot(bs, g->k) ;
+  else
+    {
+      nb = get_mot(bs, 5) ;
+      v = pow2(nb) | get_mot(bs, nb) ;
+    }
+  mise_a_jour(g, v) ;
+  return v ;
+}
+
+/*
+ * Les entiers signés sont entrelacés : 0 -1 1 -2 2 ...
+ * deviennent 0 1 2 3 4 ... pour que les petites valeurs absolues
+ * aient les petits codes.
+ */
+
+void put_entier_signe_golomb(struct bitstream *bs, struct golomb *g, int v)
+{
+  put_entier_golomb(bs, g, v < 0 ? 2*(unsigned int)-(v+1) + 1 : 2*(unsigned int)v) ;
+}
+
+int get_entier_signe_golomb(struct bitstream *bs, struct golomb *g)
+{
+  unsigned int v = get_entier_golomb(bs, g) ;
+
+  return v & 1 ? -(int)(v >> 1) - 1 : (int)(v >> 1) ;
+}
+
+/*
+ * Fonctions pour les tests, NE PAS UTILISER.
+ */
+int golomb_get_k(const struct golomb *g)
+{
+  return g->k ;
+}
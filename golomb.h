@@ -0,0 +1,23 @@
+/*
+ * Codage de Golomb-Rice adaptatif
+ */
+
+#ifndef _HOME_EXCO_REDACTEX_COURS_TRANS_COMP_IMAGE_TP_DCT2_GOLOMB_H
+#define _HOME_EXCO_REDACTEX_COURS_TRANS_COMP_IMAGE_TP_DCT2_GOLOMB_H
+
+#include "bitstream.h"
+
+struct golomb ;
+
+struct golomb* open_golomb() ;
+void close_golomb(struct golomb *g) ;
+void put_entier_golomb(struct bitstream *bs, struct golomb *g, unsigned int v) ;
+unsigned int get_entier_golomb(struct bitstream *bs, struct golomb *g) ;
+void put_entier_signe_golomb(struct bitstream *bs, struct golomb *g, int v) ;
+int get_entier_signe_golomb(struct bitstream *bs, struct golomb *g) ;
+
+/* Pour les tests */
+
+int golomb_get_k(const struct golomb *g) ; /**/
+
+#endif
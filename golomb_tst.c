@@ -0,0 +1,200 @@
+#include "golomb.h"
+#include "exception.h"
+
+static unsigned int valeurs[] = { 0, 1, 2, 3, 7, 8, 100, 1000, 32767, 32768
+				  , 65535, 1000000, 0x7FFFFFFF, 0xFFFFFFFF
+				  , 5, 4, 3, 2, 1, 0, 0, 0 } ;
+
+void open_golomb_tst()
+{
+  struct golomb *g ;
+
+  g = open_golomb() ;
+  if ( g == NULL )
+    {
+      eprintf("Elle retourne NULL !\n") ;
+      return ;
+    }
+  if ( golomb_get_k(g) != 0 )
+    {
+      eprintf("Au départ k doit être nul\n") ;
+      return ;
+    }
+  close_golomb(g) ;
+}
+
+void close_golomb_tst()
+{
+  struct golomb *g, *g2 ;
+
+  g = open_golomb() ;
+  close_golomb(g) ;
+  g2 = open_golomb() ;
+  if ( g != g2 )
+    {
+      eprintf("Vous oubliez de libérer quelque chose\n") ;
+      return ;
+    }
+  close_golomb(g2) ;
+}
+
+void put_entier_golomb_tst()
+{
+  struct golomb *g ;
+  struct bitstream *bs ;
+  unsigned char *t ;
+  size_t taille ;
+  int i ;
+
+  /*
+   * Avec k=0 le code est unaire
+   */
+  g = open_golomb() ;
+  bs = open_bitstream_memory(NULL, 0) ;
+  put_entier_golomb(bs, g, 3) ;
+  t = bitstream_memory(bs, &taille) ;
+  if ( taille != 1 || t[0] != 0x10 )
+    {
+      eprintf("3 avec k=0 doit donner 0001\n") ;
+      return ;
+    }
+  close_bitstream(bs) ;
+  close_golomb(g) ;
+
+  /*
+   * k suit la moyenne
+   */
+  g = open_golomb() ;
+  bs = open_bitstream_comptage() ;
+  for(i=0; i<100; i++)
+    put_entier_golomb(bs, g, 1000) ;
+  if ( golomb_get_k(g) != 10 )
+    {
+      eprintf("Après des 1000, k=%d au lieu de 10\n", golomb_get_k(g)) ;
+      return ;
+    }
+  for(i=0; i<1000; i++)
+    put_entier_golomb(bs, g, 1) ;
+  if ( golomb_get_k(g) > 1 )
+    {
+      eprintf("Après des 1, k=%d est trop grand\n", golomb_get_k(g)) ;
+      return ;
+    }
+  close_bitstream(bs) ;
+  close_golomb(g) ;
+}
+
+void get_entier_golomb_tst()
+{
+  struct golomb *g ;
+  struct bitstream *bs, *r ;
+  unsigned char *t ;
+  size_t taille ;
+  unsigned int v ;
+  int i, e ;
+
+  g = open_golomb() ;
+  bs = open_bitstream_memory(NULL, 0) ;
+  for(i=0; i<TAILLE(valeurs); i++)
+    put_entier_golomb(bs, g, valeurs[i]) ;
+  for(i=0; i<100000; i++)
+    put_entier_golomb(bs, g, (i*7919) % (1 + i%5000)) ;
+  close_golomb(g) ;
+  t = bitstream_memory(bs, &taille) ;
+
+  g = open_golomb() ;
+  r = open_bitstream_memory_read(t, taille) ;
+  for(i=0; i<TAILLE(valeurs); i++)
+    if ( (v = get_entier_golomb(r, g)) != valeurs[i] )
+      {
+	eprintf("Lecture de %u, je recois %u\n", valeurs[i], v) ;
+	return ;
+      }
+  for(i=0; i<100000; i++)
+    if ( get_entier_golomb(r, g) != (i*7919) % (1 + i%5000) )
+      {
+	eprintf("Mauvaise lecture de l'entier numéro %d\n", i) ;
+	return ;
+      }
+
+  /*
+   * Un flot qui ne contient que des 0 est invalide
+   */
+  e = 0 ;
+  EXCEPTION(get_entier_golomb(r, g) ;
+	    ,
+	    ,
+	    case Exception_fichier_lecture:
+	    e = 1 ;
+	    break ;
+	    ) ;
+  if ( e != 1 )
+    {
+      eprintf("Pas d'exception à la fin du flot\n") ;
+      return ;
+    }
+  close_bitstream(r) ;
+  close_bitstream(bs) ;
+  close_golomb(g) ;
+}
+
+void put_entier_signe_golomb_tst()
+{
+  struct golomb *g ;
+  struct bitstream *bs ;
+  unsigned char *t ;
+  size_t taille ;
+
+  /*
+   * Avec k=0 : 0 -1 1 -2 sont codés 1 01 001 0001
+   */
+  g = open_golomb() ;
+  bs = open_bitstream_memory(NULL, 0) ;
+  put_entier_signe_golomb(bs, g, 0) ;
+  close_golomb(g) ;
+  g = open_golomb() ;
+  put_entier_signe_golomb(bs, g, -1) ;
+  close_golomb(g) ;
+  g = open_golomb() ;
+  put_entier_signe_golomb(bs, g, 1) ;
+  close_golomb(g) ;
+  g = open_golomb() ;
+  put_entier_signe_golomb(bs, g, -2) ;
+  close_golomb(g) ;
+  t = bitstream_memory(bs, &taille) ;
+  if ( taille != 2 || t[0] != 0xA4 || t[1] != 0x40 )
+    {
+      eprintf("Mauvais entrelacement des signes\n") ;
+      return ;
+    }
+  close_bitstream(bs) ;
+}
+
+void get_entier_signe_golomb_tst()
+{
+  struct golomb *g ;
+  struct bitstream *bs, *r ;
+  unsigned char *t ;
+  size_t taille ;
+  int i, v ;
+  static int s[] = { 0, -1, 1, 40000, -40000, 0x7FFFFFFF, -0x7FFFFFFF-1, 3 } ;
+
+  g = open_golomb() ;
+  bs = open_bitstream_memory(NULL, 0) ;
+  for(i=0; i<TAILLE(s); i++)
+    put_entier_signe_golomb(bs, g, s[i]) ;
+  close_golomb(g) ;
+  t = bitstream_memory(bs, &taille) ;
+
+  g = open_golomb() ;
+  r = open_bitstream_memory_read(t, taille) ;
+  for(i=0; i<TAILLE(s); i++)
+    if ( (v = get_entier_signe_golomb(r, g)) != s[i] )
+      {
+	eprintf("Lecture de %d, je recois %d\n", s[i], v) ;
+	return ;
+      }
+  close_bitstream(r) ;
+  close_bitstream(bs) ;
+  close_golomb(g) ;
+}
@@ -0,0 +1,371 @@
+#include "huffman.h"
+#include "bits.h"
+#include "exception.h"
+
+/*
+ * Codage de Huffman canonique d'un bloc d'entiers (non signés).
+ *
+ * Première passe : on compte les symboles du bloc et on calcule
+ * les longueurs des codes de Huffman, limitées à LONGUEUR_MAX_HUFFMAN.
+ * Seules les longueurs sont transmises : les codes canoniques
+ * s'en déduisent (codes croissants par longueur puis par symbole).
+ * Deuxième passe : on écrit le code de chaque entier.
+ *
+ * Les entiers inférieurs à NB_DIRECT sont des symboles.
+ * Les autres sont codés par le symbole "NB_DIRECT + nb_bits - 9"
+ * (nb_bits de 9 à 32) suivi de leurs bits sans le premier 1.
+ *
+ * En-tête : le nombre de longueurs transmises sur 9 bits,
+ * puis chaque longueur sur 4 bits. Une longueur nulle est suivie
+ * sur 5 bits du nombre de longueurs nulles qui la suivent.
+ *
+ * Le décodage regarde BITS_TABLE_HUFFMAN bits d'un coup : la table
+ * donne tous les symboles (MAX_SYMBOLES_TABLE au plus) dont les codes
+ * sont entièrement dans ces bits. Les codes plus longs sont décodés
+ * avec les premiers codes de chaque longueur.
+ */
+
+#define NB_DIRECT 256
+#define NB_SYMBOLES (NB_DIRECT + 24)
+#define LONGUEUR_MAX_HUFFMAN 15
+#define BITS_TABLE_HUFFMAN 11
+#define MAX_SYMBOLES_TABLE 4
+
+struct canonique
+{
+  unsigned char longueur[NB_SYMBOLES] ;
+  unsigned int code[NB_SYMBOLES] ;
+  int nombre[LONGUEUR_MAX_HUFFMAN + 1] ;  /* Nombre de codes par longueur */
+  unsigned int premier[LONGUEUR_MAX_HUFFMAN + 1] ; /* Premier code */
+  int index[LONGUEUR_MAX_HUFFMAN + 1] ;	   /* Son indice dans "tries" */
+  unsigned short tries[NB_SYMBOLES] ;	   /* Par longueur puis symbole */
+} ;
+
+struct entree_huffman
+{
+  unsigned char nb ;		/* Nombre de symboles décodés */
+  unsigned char longueur[MAX_SYMBOLES_TABLE] ; /* Bits consommés après chacun */
+  unsigned short symbole[MAX_SYMBOLES_TABLE] ;
+} ;
+
+static int symbole(unsigned int v)
+{
+  if ( v < NB_DIRECT )
+    return v ;
+  return NB_DIRECT + nb_bits_utile(v) - 9 ;
+}
+
+/*
+ * Nombre de bits écrits après le code du symbole
+ */
+
+static int nb_bits_en_plus(int s)
+{
+  return s < NB_DIRECT ? 0 : s - NB_DIRECT + 8 ;
+}
+
+/*
+ * Calcule les longueurs des codes de Huffman des "nb_symboles" symboles
+ * (0 pour un symbole absent) sans dépasser "longueur_max".
+ *
+ * Les symboles présents sont triés par nombre d'occurrences croissant,
+ * l'arbre est construit avec deux files (feuilles et noeuds internes
+ * sont créés par poids croissant). Si des codes sont trop longs
+ * les longueurs sont corrigées comme dans JPEG (annexe K.3) :
+ * deux feuilles les plus profondes remontent et une feuille moins
+ * profonde descend, puis les longueurs sont redistribuées
+ * dans l'ordre des occurrences.
+ */
+
+void longueurs_huffman(const unsigned int *nb_occurrences, int nb_symboles
+		       , int longueur_max, unsigned char *longueurs)
+{
+  int *feuilles, *parent, *profondeur, *nb_par_longueur ;
+  unsigned long *poids ;
+  int i, j, k, m, l, a[2] ;
+
+  ALLOUER(feuilles, nb_symboles) ;
+  for(m = 0, i = 0; i < nb_symboles; i++)
+    {
+      longueurs[i] = 0 ;
+      if ( nb_occurrences[i] )
+	{
+	  /* Tri par insertion : l'alphabet est petit */
+	  for(j = m++; j > 0 && nb_occurrences[feuilles[j-1]] > nb_occurrences[i]; j--)
+	    feuilles[j] = feuilles[j-1] ;
+	  feuilles[j] = i ;
+	}
+    }
+  if ( m <= 1 )
+    {
+      if ( m == 1 )
+	longueurs[feuilles[0]] = 1 ;
+      free(feuilles) ;
+      return ;
+    }
+
+  ALLOUER(poids, 2*m - 1) ;
+  ALLOUER(parent, 2*m - 1) ;
+  ALLOUER(profondeur, 2*m - 1) ;
+  ALLOUER(nb_par_longueur, m + 1) ;
+  for(i = 0; i < m; i++)
+    poids[i] = nb_occurrences[feuilles[i]] ;
+  for(i = 0, j = m, k = m; k < 2*m - 1; k++)
+    {
+      for(l = 0; l < 2; l++)
+	if ( i < m && (j >= k || poids[i] <= poids[j]) )
+	  a[l] = i++ ;
+	else
+	  a[l] = j++ ;
+      poids[k] = poids[a[0]] + poids[a[1]] ;
+      parent[a[0]] = parent[a[1]] = k ;
+    }
+  profondeur[2*m - 2] = 0 ;
+  for(k = 2*m - 3; k >= 0; k--)
+    profondeur[k] = profondeur[parent[k]] + 1 ;
+
+  for(l = 0; l <= m; l++)
+    nb_par_longueur[l] = 0 ;
+  for(i = 0; i < m; i++)
+    nb_par_longueur[profondeur[i]]++ ;
+
+  for(l = m; l > longueur_max; l--)
+    while(nb_par_longueur[l] > 0)
+      {
+	for(j = l - 2; nb_par_longueur[j] == 0; j--)
+	  ;
+	nb_par_longueur[l] -= 2 ;
+	nb_par_longueur[l-1]++ ;
+	nb_par_longueur[j+1] += 2 ;
+	nb_par_longueur[j]-- ;
+      }
+
+  /* Les plus longs codes vont aux symboles les moins fréquents */
+  for(i = 0, l = longueur_max < m ? longueur_max : m; l > 0; l--)
+    for(k = 0; k < nb_par_longueur[l]; k++)
+      longueurs[feuilles[i++]] = l ;
+
+  free(feuilles) ;
+  free(poids) ;
+  free(parent) ;
+  free(profondeur) ;
+  free(nb_par_longueur) ;
+}
+
+/*
+ * Codes canoniques à partir des longueurs
+ */
+
+static void calcule_codes(struct canonique *c)
+{
+  unsigned int code ;
+  int s, l, position, rang[LONGUEUR_MAX_HUFFMAN + 1] ;
+
+  for(l = 0; l <= LONGUEUR_MAX_HUFFMAN; l++)
+    {
+      c->nombre[l] = 0 ;
+      rang[l] = 0 ;
+    }
+  for(s = 0; s < NB_SYMBOLES; s++)
+    c->nombre[c->longueur[s]]++ ;
+  c->nombre[0] = 0 ;
+
+  for(code = 0, position = 0, l = 1; l <= LONGUEUR_MAX_HUFFMAN; l++)
+    {
+      c->premier[l] = code ;
+      c->index[l] = position ;
+      position += c->nombre[l] ;
+      code = (code + c->nombre[l]) << 1 ;
+    }
+  for(s = 0; s < NB_SYMBOLES; s++)
+    if ( (l = c->longueur[s]) )
+      {
+	c->code[s] = c->premier[l] + rang[l] ;
+	c->tries[c->index[l] + rang[l]++] = s ;
+      }
+}
+
+/*
+ * Ecriture et lecture des longueurs (voir l'en-tête plus haut)
+ */
+
+static void ecrit_longueurs(struct bitstream *bs, const struct canonique *c)
+{
+  int s, nb, n ;
+
+  for(nb = NB_SYMBOLES; nb > 0 && c->longueur[nb-1] == 0; nb--)
+    ;
+  put_bits(bs, 9, nb) ;
+  for(s = 0; s < nb; s++)
+    {
+      put_bits(bs, 4, c->longueur[s]) ;
+      if ( c->longueur[s] == 0 )
+	{
+	  for(n = 0; n < 31 && s + 1 < nb && c->longueur[s+1] == 0; n++)
+	    s++ ;
+	  put_bits(bs, 5, n) ;
+	}
+    }
+}
+
+static void lit_longueurs(struct bitstream *bs, struct canonique *c)
+{
+  int s, nb, n ;
+
+  nb = get_bits(bs, 9) ;
+  if ( nb > NB_SYMBOLES )
+    EXCEPTION_LANCE(Exception_fichier_lecture) ;
+  memset(c->longueur, 0, sizeof(c->longueur)) ;
+  for(s = 0; s < nb; s++)
+    {
+      c->longueur[s] = get_bits(bs, 4) ;
+      if ( c->longueur[s] == 0 )
+	{
+	  n = get_bits(bs, 5) ;
+	  if ( s + n >= nb )
+	    EXCEPTION_LANCE(Exception_fichier_lecture) ;
+	  s += n ;
+	}
+    }
+}
+
+/*
+ * Symbole dont le code est au début des "nb" bits de "bits".
+ * Retourne -1 si aucun code ne tient dans ces bits.
+ */
+
+static int decode_canonique(const struct canonique *c, unsigned int bits
+			    , int nb, int *longueur)
+{
+  unsigned int code ;
+  int l ;
+
+  for(l = 1; l <= nb && l <= LONGUEUR_MAX_HUFFMAN; l++)
+    {
+      code = bits >> (nb - l) ;
+      if ( code - c->premier[l] < (unsigned int)c->nombre[l] )
+	{
+	  *longueur = l ;
+	  return c->tries[c->index[l] + code - c->premier[l]] ;
+	}
+    }
+  return -1 ;
+}
+
+/*
+ * Remplit la table de décodage : pour chaque valeur des
+ * BITS_TABLE_HUFFMAN prochains bits, les symboles qu'elle contient.
+ * Un symbole suivi de bits en plus termine l'entrée.
+ */
+
+static void remplit_table_huffman(const struct canonique *c
+				  , struct entree_huffman *table)
+{
+  unsigned int x ;
+  int position, reste, s, l ;
+  struct entree_huffman *e ;
+
+  for(x = 0; x < 1u << BITS_TABLE_HUFFMAN; x++)
+    {
+      e = &table[x] ;
+      e->nb = 0 ;
+      position = 0 ;
+      while(e->nb < MAX_SYMBOLES_TABLE)
+	{
+	  reste = BITS_TABLE_HUFFMAN - position ;
+	  if ( reste == 0 )
+	    break ;
+	  s = decode_canonique(c, x & ((1u << reste) - 1), reste, &l) ;
+	  if ( s < 0 )
+	    break ;
+	  position += l ;
+	  e->symbole[e->nb] = s ;
+	  e->longueur[e->nb++] = position ;
+	  if ( s >= NB_DIRECT )
+	    break ;
+	}
+    }
+}
+
+/*
+ * Ecrit les "n" entiers de "v" : en-tête puis codes.
+ * Le nombre d'entiers n'est pas écrit.
+ */
+
+void put_huffman(struct bitstream *bs, const unsigned int *v, size_t n)
+{
+  struct canonique c ;
+  unsigned int nb_occurrences[NB_SYMBOLES] ;
+  size_t i ;
+  int s, plus ;
+
+  if ( n == 0 )
+    return ;
+  memset(nb_occurrences, 0, sizeof(nb_occurrences)) ;
+  for(i = 0; i < n; i++)
+    nb_occurrences[symbole(v[i])]++ ;
+  longueurs_huffman(nb_occurrences, NB_SYMBOLES, LONGUEUR_MAX_HUFFMAN
+		    , c.longueur) ;
+  calcule_codes(&c) ;
+  ecrit_longueurs(bs, &c) ;
+
+  for(i = 0; i < n; i++)
+    {
+      s = symbole(v[i]) ;
+      plus = nb_bits_en_plus(s) ;
+      put_mot(bs, c.longueur[s] + plus
+	      , ((Buffer_Bit)c.code[s] << plus) | (v[i] & ((1ULL << plus) - 1))) ;
+    }
+}
+
+/*
+ * Lit les "n" entiers écrits par "put_huffman"
+ */
+
+void get_huffman(struct bitstream *bs, unsigned int *v, size_t n)
+{
+  struct canonique c ;
+  struct entree_huffman *table, *e ;
+  size_t i ;
+  int k, nb, s, l, plus ;
+
+  if ( n == 0 )
+    return ;
+  lit_longueurs(bs, &c) ;
+  calcule_codes(&c) ;
+  ALLOUER(table, 1 << BITS_TABLE_HUFFMAN) ;
+  remplit_table_huffman(&c, table) ;
+
+  for(i = 0; i < n; )
+    {
+      e = &table[peek_bits(bs, BITS_TABLE_HUFFMAN)] ;
+      if ( e->nb )
+	{
+	  nb = e->nb ;
+	  if ( (size_t)nb > n - i )
+	    nb = n - i ;
+	  for(k = 0; k < nb; k++)
+	    v[i++] = e->symbole[k] ;
+	  skip_bits(bs, e->longueur[nb-1]) ;
+	  s = e->symbole[nb-1] ;
+	}
+      else
+	{
+	  s = decode_canonique(&c, peek_bits(bs, LONGUEUR_MAX_HUFFMAN)
+			       , LONGUEUR_MAX_HUFFMAN, &l) ;
+	  if ( s < 0 )
+	    {
+	      free(table) ;
+	      EXCEPTION_LANCE(Exception_fichier_lecture) ;
+	    }
+	  skip_bits(bs, l) ;
+	  v[i++] = s ;
+	}
+      if ( s >= NB_DIRECT )
+	{
+	  plus = nb_bits_en_plus(s) ;
+	  v[i-1] = (1u << plus) | get_mot(bs, plus) ;
+	}
+    }
+  free(table) ;
+}
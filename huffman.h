@@ -0,0 +1,14 @@
+/*
+ * Codage de Huffman canonique en deux passes, par bloc d'entiers
+ */
+
+#ifndef _HOME_EXCO_REDACTEX_COURS_TRANS_COMP_IMAGE_TP_DCT2_HUFFMAN_H
+#define _HOME_EXCO_REDACTEX_COURS_TRANS_COMP_IMAGE_TP_DCT2_HUFFMAN_H
+
+#include "bitstream.h"
+
+void longueurs_huffman(const unsigned int *nb_occurrences, int nb_symboles, int longueur_max, unsigned char *longueurs) ;
+void put_huffman(struct bitstream *bs, const unsigned int *v, size_t n) ;
+void get_huffman(struct bitstream *bs, unsigned int *v, size_t n) ;
+
+#endif
@@ -0,0 +1,150 @@
+#include "huffman.h"
+#include "exception.h"
+
+/*
+ * Somme des 2^-longueur (multipliée par 2^15) : 2^15 pour un code complet
+ */
+
+static unsigned long kraft(const unsigned char *longueurs, int n)
+{
+  unsigned long somme = 0 ;
+  int i ;
+
+  for(i=0; i<n; i++)
+    if ( longueurs[i] )
+      somme += 1UL << (15 - longueurs[i]) ;
+  return somme ;
+}
+
+void longueurs_huffman_tst()
+{
+  static unsigned int occ[] = { 5, 0, 9, 12, 13, 16, 45 } ;
+  static unsigned char ok[] = { 4, 0, 4, 3, 3, 3, 1 } ;
+  unsigned int fibonacci[30] ;
+  unsigned char l[30] ;
+  int i ;
+
+  longueurs_huffman(occ, TAILLE(occ), 15, l) ;
+  for(i=0; i<TAILLE(occ); i++)
+    if ( l[i] != ok[i] )
+      {
+	eprintf("Le symbole %d a la longueur %d au lieu de %d\n"
+		, i, l[i], ok[i]) ;
+	return ;
+      }
+
+  /* Un seul symbole a un code de 1 bit */
+  longueurs_huffman(occ, 1, 15, l) ;
+  if ( l[0] != 1 )
+    {
+      eprintf("Un symbole seul doit avoir un code d'un bit\n") ;
+      return ;
+    }
+
+  /*
+   * Avec les nombres de Fibonacci l'arbre a une profondeur de 29,
+   * les longueurs doivent être limitées sans perdre de code.
+   */
+  fibonacci[0] = fibonacci[1] = 1 ;
+  for(i=2; i<TAILLE(fibonacci); i++)
+    fibonacci[i] = fibonacci[i-1] + fibonacci[i-2] ;
+  longueurs_huffman(fibonacci, TAILLE(fibonacci), 15, l) ;
+  for(i=0; i<TAILLE(fibonacci); i++)
+    if ( l[i] == 0 || l[i] > 15 )
+      {
+	eprintf("Longueur %d hors limite pour le symbole %d\n", l[i], i) ;
+	return ;
+      }
+  if ( kraft(l, TAILLE(fibonacci)) != 1UL << 15 )
+    {
+      eprintf("Les codes limités ne forment pas un code complet\n") ;
+      return ;
+    }
+  for(i=1; i<TAILLE(fibonacci); i++)
+    if ( l[i] > l[i-1] )
+      {
+	eprintf("Un symbole plus fréquent a un code plus long\n") ;
+	return ;
+      }
+}
+
+void put_huffman_tst()
+{
+  static unsigned int v[] = { 3, 3, 3, 3, 7 } ;
+  struct bitstream *bs ;
+
+  /*
+   * 9 bits pour le nombre de longueurs (8), 8 longueurs dont
+   * deux suites de 3 nulles (4 + 5 bits chacune),
+   * puis 5 codes de 1 bit.
+   */
+  bs = open_bitstream_memory(NULL, 0) ;
+  put_huffman(bs, v, TAILLE(v)) ;
+  if ( bitstream_nb_bits(bs) != 9 + 2*(4+5) + 2*4 + 5 )
+    {
+      eprintf("%llu bits écrits au lieu de %d\n", bitstream_nb_bits(bs)
+	      , 9 + 2*(4+5) + 2*4 + 5) ;
+      return ;
+    }
+  close_bitstream(bs) ;
+}
+
+void get_huffman_tst()
+{
+  static unsigned int v[20000], w[20000+1] ;
+  struct bitstream *bs, *lu ;
+  unsigned char *buf ;
+  size_t taille, n ;
+  int i, j, r ;
+
+  for(j=0; j<4; j++)
+    {
+      for(i=0; i<TAILLE(v); i++)
+	switch(j)
+	  {
+	  case 0: v[i] = rand() % 20 ; break ;
+	  case 1: v[i] = (unsigned int)rand() >> (rand() % 32) ; break ;
+	  case 2: v[i] = i % 300 == 0 ? 0xFFFFFFFF : rand() % 3 ; break ;
+	  case 3: v[i] = 1 << (i % 32) ; break ;
+	  }
+      for(n=0; n<TAILLE(v); n += n < 20 ? 1 : 4999)
+	{
+	  bs = open_bitstream_memory(NULL, 0) ;
+	  put_huffman(bs, v, n) ;
+	  buf = bitstream_memory(bs, &taille) ;
+	  lu = open_bitstream_memory_read(buf, taille) ;
+	  w[n] = 1234 ;
+	  get_huffman(lu, w, n) ;
+	  close_bitstream(lu) ;
+	  close_bitstream(bs) ;
+	  if ( memcmp(v, w, n*sizeof(*v)) || w[n] != 1234 )
+	    {
+	      eprintf("Mauvais décodage de %lu entiers (cas %d)\n"
+		      , (unsigned long)n, j) ;
+	      return ;
+	    }
+	}
+    }
+
+  /*
+   * Un flot tronqué
+   */
+  for(i=0; i<1000; i++)
+    v[i] = rand() % 1000 ;
+  bs = open_bitstream_memory(NULL, 0) ;
+  put_huffman(bs, v, 1000) ;
+  buf = bitstream_memory(bs, &taille) ;
+  lu = open_bitstream_memory_read(buf, taille/2) ;
+  r = 0 ;
+  EXCEPTION(get_huffman(lu, w, 1000) ;
+	    ,
+	    ,
+	    case Exception_fichier_lecture:
+	    r = 1 ;
+	    break ;
+	    ) ;
+  close_bitstream(lu) ;
+  close_bitstream(bs) ;
+  if ( r == 0 )
+    eprintf("Pas d'exception sur un flot tronqué\n") ;
+}
@@ -1,3 +1,7 @@
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
 #include "image.h"
 
 
@@ -32,6 +36,8 @@ struct image* allocation_image(int hauteur, int largeur)
 	//Remplissage des champs
 	img->hauteur = hauteur;
 	img->largeur = largeur;
+	img->projection = NULL;
+	img->taille_projection = 0;
 	ALLOUER(img->pixels, hauteur);
 	for(indice_hauteur = 0; indice_hauteur < hauteur; indice_hauteur++)
 	{
@@ -48,14 +54,60 @@ struct image* allocation_image(int hauteur, int largeur)
 void liberation_image(struct image* image)
 {
 	int indice_hauteur;
-	for(indice_hauteur = 0; indice_hauteur < image->hauteur; indice_hauteur++)
-	{
-		free(image->pixels[indice_hauteur]);
-	}
+	if(image->projection)
+		munmap(image->projection, image->taille_projection);
+	else
+		for(indice_hauteur = 0; indice_hauteur < image->hauteur; indice_hauteur++)
+		{
+			free(image->pixels[indice_hauteur]);
+		}
 	free(image->pixels);
 	free(image);
 }
 
+/*
+ * Si "f" est un fichier normal, les lignes de l'image pointent
+ * directement dans la projection mémoire du fichier (sans recopie).
+ * La projection est privée : modifier un pixel ne modifie pas le fichier.
+ * Retourne Faux si le fichier ne peut pas être projeté.
+ */
+
+static int projection_image(FILE *f, int hauteur, int largeur
+			    , struct image **img)
+{
+	struct stat st;
+	long debut;
+	size_t taille;
+	unsigned char *projection;
+	int indice_hauteur;
+
+	debut = ftell(f);
+	if(debut < 0 || fstat(fileno(f), &st) != 0 || !S_ISREG(st.st_mode))
+		return 0;
+	taille = debut + (size_t)hauteur * largeur;
+	if(st.st_size < taille)
+		return 0;
+
+	projection = mmap(NULL, taille, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+			  fileno(f), 0);
+	if(projection == MAP_FAILED)
+		return 0;
+
+	ALLOUER(*img, 1);
+	(*img)->hauteur = hauteur;
+	(*img)->largeur = largeur;
+	(*img)->projection = projection;
+	(*img)->taille_projection = taille;
+	ALLOUER((*img)->pixels, hauteur);
+	for(indice_hauteur = 0; indice_hauteur < hauteur; indice_hauteur++)
+		(*img)->pixels[indice_hauteur] = projection + debut
+			+ (size_t)indice_hauteur * largeur;
+
+	//Le fichier est lu comme si on avait fait les "fgetc"
+	fseek(f, taille, SEEK_SET);
+	return 1;
+}
+
 /*
  * Allocation et lecture d'un image au format PGM.
  * (L'entête commence par "P5\nLargeur Hauteur\n255\n"
@@ -82,18 +134,22 @@ struct image* lecture_image(FILE *f)
 	//Recuperation hauteut largeur
 	//Possiblité de fgets pour stoker nombre dans une chaine et recup avec atoi
 	fscanf(f, "%d%d%*c", &largeur, &hauteur);
-	//Allocation de l'image
-	img = allocation_image(hauteur, largeur);
 
 	//On lit d'eventuelles lignes de commentaires et le 255
 	lire_ligne(f, ligne);
 
+	//Fichier normal : les pixels sont pris dans la projection mémoire
+	if(projection_image(f, hauteur, largeur, &img))
+		return img;
+
+	//Sinon (tube, entrée standard...) lecture ligne par ligne
+	img = allocation_image(hauteur, largeur);
 	for(indice_hauteur = 0; indice_hauteur < img->hauteur; indice_hauteur++)
 	{
-		for(indice_largeur = 0; indice_largeur < img->largeur; indice_largeur++)
-		{
-			img->pixels[indice_hauteur][indice_largeur] = fgetc(f);
-		}
+		indice_largeur = fread(img->pixels[indice_hauteur], 1, img->largeur, f);
+		//Comme "fgetc", on met EOF s'il manque des pixels
+		memset(img->pixels[indice_hauteur] + indice_largeur, EOF,
+		       img->largeur - indice_largeur);
 	}
 
 	//free(ligne);
@@ -12,6 +12,8 @@ struct image
   int largeur ;
   int hauteur ;
   unsigned char **pixels ;
+  unsigned char *projection ;	/* Fichier projeté (les lignes pointent dedans) */
+  size_t taille_projection ;
 } ;
 
 #define MAXLIGNE 9999 /* Longueur maximale d'une ligne de commentaire */
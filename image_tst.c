@@ -72,7 +72,8 @@ void liberation_image_tst()
 
 void lecture_image_tst()
 {
-  struct image *image ;
+  struct image *image, *image2 ;
+  FILE *f ;
   int j, i ;
   int s ;
 
@@ -93,7 +94,25 @@ void lecture_image_tst()
       s += (j*image->pixels[j][i])/(i+1) ;
 
   if ( s != 5709193 )
-    eprintf("Mauvais pixels : Checksum = %d\n", s) ;
+    {
+      eprintf("Mauvais pixels : Checksum = %d\n", s) ;
+      return ;
+    }
+
+  /*
+   * Même image lue dans un tube (pas de projection mémoire possible)
+   */
+  f = popen("cat DONNEES/bat710.pgm", "r") ;
+  image2 = lecture_image(f) ;
+  pclose(f) ;
+  for(j=0; j<image->hauteur; j++)
+    if ( memcmp(image->pixels[j], image2->pixels[j], image->largeur) )
+      {
+	eprintf("La ligne %d lue dans un tube est différente\n", j) ;
+	return ;
+      }
+  liberation_image(image2) ;
+  liberation_image(image) ;
 }
 
 
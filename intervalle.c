@@ -0,0 +1,560 @@
+#include "intervalle.h"
+#include "bit.h"
+#include "exception.h"
+
+/*
+ * Codage par intervalles (un codage arithmétique sur des octets)
+ * avec un modèle adaptatif.
+ *
+ * Comme dans "sf.c", le modèle commence avec le seul symbole ESCAPE.
+ * Une valeur inconnue est codée par ESCAPE puis elle est ajoutée
+ * au modèle. Après ESCAPE, la valeur entrelacée (0 -1 1 -2 2...)
+ * est codée par son nombre de bits, avec un second modèle adaptatif
+ * de NB_CLASSES symboles, puis ses bits sans le premier 1
+ * (équiprobables, par paquets de 16 au plus). Les symboles ne changent jamais de place :
+ * le symbole 0 est ESCAPE, les autres sont dans l'ordre d'arrivée.
+ *
+ * Chaque occurrence ajoute INCREMENT à la fréquence du symbole.
+ * Quand le total dépasse "total_max" (TOTAL_MAX par défaut, voir
+ * "vieillissement_intervalle") toutes les fréquences sont
+ * divisées par deux (sans descendre à 0) : le modèle suit
+ * les variations et le total reste codable.
+ * Les fréquences cumulées sont dans un arbre de Fenwick.
+ *
+ * Le codeur propage les retenues (comme celui de LZMA) : "bas" est
+ * sur 64 bits, l'intervalle sur 32 bits ne descend jamais sous HAUT.
+ * Un octet suivi de 0xFF peut encore recevoir une retenue, il reste
+ * en attente ("cache" et "nb_attente") jusqu'à ce qu'elle soit connue.
+ * Le premier octet produit est toujours nul, il n'est pas écrit.
+ * Les totaux jusqu'à TOTAL_MAX_LIMITE restent codables :
+ * la fenêtre d'adaptation peut être longue.
+ *
+ * Le modèle n'est pas remis à zéro entre deux appels :
+ * le décodeur doit décoder les mêmes blocs dans le même ordre.
+ *
+ * Le premier bloc commence par le seuil "total_max" : un symbole
+ * équiprobable (0 : TOTAL_MAX), sinon le seuil sur 11 puis 12 bits.
+ * Le décodeur prend le seuil qu'il lit.
+ */
+
+#define HAUT (1u << 24)
+#define TOTAL_MAX_LIMITE (1 << 22)
+#define TOTAL_MAX (1 << 18)
+#define TOTAL_MAX_CLASSES (1 << 16)
+#define INCREMENT 24
+#define ESCAPE 0
+#define NB_CLASSES 33
+
+struct intervalle
+{
+  int nb_symboles ;
+  int taille ;			/* Cases allouées, puissance de 2 */
+  int *valeurs ;		/* Valeur de chaque symbole */
+  int *frequences ;
+  int *arbre ;			/* Fenwick des fréquences, "taille + 1" */
+  int total ;
+  int total_max ;
+  int nb_max_symboles ;		/* Au delà : toujours ESCAPE */
+  Booleen entete ;		/* Le seuil est écrit/lu */
+  int *index ;			/* Hachage valeur -> symbole (-1 : vide) */
+  int taille_index ;		/* Puissance de 2 */
+  int classes[NB_CLASSES] ;	/* Fréquences des nombres de bits */
+  int total_classes ;
+} ;
+
+/*
+ * État du codeur ou du décodeur
+ */
+
+struct codeur
+{
+  unsigned long long bas ;
+  unsigned int intervalle ;
+  unsigned int code ;		/* Décodeur seulement */
+  unsigned char cache ;		/* Codeur seulement */
+  size_t nb_attente ;		/* Octets en attente de retenue */
+  Booleen premier ;		/* Le premier octet, nul, est sauté */
+  unsigned char *octets ;
+  size_t taille ;		/* Octets écrits ou lus */
+  size_t taille_max ;		/* Octets alloués ou disponibles */
+} ;
+
+/*
+ * Le modèle
+ */
+
+static void ajoute_frequence(struct intervalle *m, int s, int f)
+{
+  m->frequences[s] += f ;
+  m->total += f ;
+  for(s++ ; s <= m->taille ; s += s & -s)
+    m->arbre[s] += f ;
+}
+
+static int cumul(const struct intervalle *m, int s)
+{
+  int somme = 0 ;
+
+  for( ; s > 0 ; s -= s & -s)
+    somme += m->arbre[s] ;
+  return somme ;
+}
+
+/*
+ * Symbole dont l'intervalle cumulé contient "cible",
+ * le début de son intervalle est stocké dans "*debut".
+ */
+
+static int cherche_symbole(const struct intervalle *m, int cible, int *debut)
+{
+  int s = 0, pas ;
+
+  *debut = 0 ;
+  for(pas = m->taille ; pas ; pas /= 2)
+    if ( s + pas <= m->taille && *debut + m->arbre[s + pas] <= cible )
+      {
+	s += pas ;
+	*debut += m->arbre[s] ;
+      }
+  return s ;
+}
+
+static void reconstruit_arbre(struct intervalle *m)
+{
+  int i, j ;
+
+  for(i = 1; i <= m->taille; i++)
+    m->arbre[i] = i <= m->nb_symboles ? m->frequences[i-1] : 0 ;
+  for(i = 1; i <= m->taille; i++)
+    {
+      j = i + (i & -i) ;
+      if ( j <= m->taille )
+	m->arbre[j] += m->arbre[i] ;
+    }
+}
+
+static void divise_frequences(struct intervalle *m)
+{
+  int s ;
+
+  m->total = 0 ;
+  for(s = 0; s < m->nb_symboles; s++)
+    {
+      m->frequences[s] = (m->frequences[s] + 1) / 2 ;
+      m->total += m->frequences[s] ;
+    }
+  reconstruit_arbre(m) ;
+}
+
+static unsigned int hache(int valeur, int taille)
+{
+  return ((unsigned int)valeur * 2654435761u) & (taille - 1) ;
+}
+
+/*
+ * Case de l'index où est (ou doit être) la valeur
+ */
+
+static int *case_index(const struct intervalle *m, int valeur)
+{
+  unsigned int i ;
+
+  for(i = hache(valeur, m->taille_index) ;
+      m->index[i] >= 0 && m->valeurs[m->index[i]] != valeur ;
+      i = (i + 1) & (m->taille_index - 1))
+    ;
+  return &m->index[i] ;
+}
+
+static void agrandit(struct intervalle *m)
+{
+  int i ;
+
+  m->taille *= 2 ;
+  m->valeurs = realloc(m->valeurs, m->taille * sizeof(*m->valeurs)) ;
+  m->frequences = realloc(m->frequences, m->taille * sizeof(*m->frequences)) ;
+  free(m->arbre) ;
+  ALLOUER(m->arbre, m->taille + 1) ;
+  free(m->index) ;
+  m->taille_index = 2 * m->taille ;
+  ALLOUER(m->index, m->taille_index) ;
+  if ( m->valeurs == NULL || m->frequences == NULL )
+    {
+      fprintf(stderr, "Plus de memoire\n") ;
+      EXIT ;
+    }
+  for(i = 0; i < m->taille_index; i++)
+    m->index[i] = -1 ;
+  for(i = 1; i < m->nb_symboles; i++)
+    *case_index(m, m->valeurs[i]) = i ;
+  reconstruit_arbre(m) ;
+}
+
+/*
+ * Mise à jour après le codage du symbole "s"
+ */
+
+static void compte(struct intervalle *m, int s)
+{
+  ajoute_frequence(m, s, INCREMENT) ;
+  if ( m->total > m->total_max - INCREMENT )
+    divise_frequences(m) ;
+}
+
+static void ajoute_symbole(struct intervalle *m, int valeur)
+{
+  if ( m->nb_symboles == m->taille )
+    agrandit(m) ;
+  m->valeurs[m->nb_symboles] = valeur ;
+  m->frequences[m->nb_symboles] = 0 ;
+  if ( m->nb_symboles != ESCAPE )
+    *case_index(m, valeur) = m->nb_symboles ;
+  m->nb_symboles++ ;
+  compte(m, m->nb_symboles - 1) ;
+}
+
+struct intervalle* open_intervalle()
+{
+  struct intervalle *m ;
+  int i ;
+
+  ALLOUER(m, 1) ;
+  m->nb_symboles = 0 ;
+  m->taille = 32 ;
+  m->total = 0 ;
+  m->total_max = TOTAL_MAX ;
+  m->nb_max_symboles = TOTAL_MAX / 4 ;
+  m->entete = Faux ;
+  ALLOUER(m->valeurs, m->taille) ;
+  ALLOUER(m->frequences, m->taille) ;
+  ALLOUER(m->arbre, m->taille + 1) ;
+  memset(m->arbre, 0, (m->taille + 1) * sizeof(*m->arbre)) ;
+  m->taille_index = 2 * m->taille ;
+  ALLOUER(m->index, m->taille_index) ;
+  memset(m->index, -1, m->taille_index * sizeof(*m->index)) ;
+  for(i = 0; i < NB_CLASSES; i++)
+    m->classes[i] = 1 ;
+  m->total_classes = NB_CLASSES ;
+  ajoute_symbole(m, 0) ;	/* ESCAPE */
+  return m ;
+}
+
+/*
+ * Change le seuil de division des fréquences, juste après l'ouverture.
+ * Plus il est grand, plus le modèle se souvient du passé.
+ * Le seuil est transmis : il est inutile de l'appeler avant le décodage.
+ */
+
+void vieillissement_intervalle(struct intervalle *m, int total_max)
+{
+  if ( total_max < 1024 || total_max > TOTAL_MAX_LIMITE )
+    {
+      fprintf(stderr, "Seuil de l'intervalle incorrect : %d\n", total_max) ;
+      EXIT ;
+    }
+  m->total_max = total_max ;
+  m->nb_max_symboles = total_max / 4 ;
+}
+
+void close_intervalle(struct intervalle *m)
+{
+  free(m->valeurs) ;
+  free(m->frequences) ;
+  free(m->arbre) ;
+  free(m->index) ;
+  free(m) ;
+}
+
+/*
+ * Le codeur
+ */
+
+static void sort_octet(struct codeur *c, unsigned char o)
+{
+  if ( c->premier )
+    {
+      c->premier = Faux ;
+      return ;
+    }
+  if ( c->taille == c->taille_max )
+    {
+      c->taille_max = 2 * c->taille_max + 64 ;
+      c->octets = realloc(c->octets, c->taille_max) ;
+      if ( c->octets == NULL )
+	{
+	  fprintf(stderr, "Plus de memoire\n") ;
+	  EXIT ;
+	}
+    }
+  c->octets[c->taille++] = o ;
+}
+
+static unsigned char lit_octet(struct codeur *c)
+{
+  if ( c->taille == c->taille_max )
+    EXCEPTION_LANCE(Exception_fichier_lecture) ;
+  return c->octets[c->taille++] ;
+}
+
+/*
+ * Sort l'octet de poids fort des 32 bits de "bas",
+ * ou le met en attente s'il peut encore recevoir une retenue.
+ */
+
+static void decale_bas(struct codeur *c)
+{
+  unsigned char retenue ;
+
+  if ( (unsigned int)c->bas < 0xFF000000u || (c->bas >> 32) != 0 )
+    {
+      retenue = c->bas >> 32 ;
+      sort_octet(c, c->cache + retenue) ;
+      for( ; c->nb_attente > 1 ; c->nb_attente--)
+	sort_octet(c, 0xFF + retenue) ;
+      c->nb_attente = 0 ;
+      c->cache = c->bas >> 24 ;
+    }
+  c->nb_attente++ ;
+  c->bas = (c->bas & 0x00FFFFFF) << 8 ;
+}
+
+static void code(struct codeur *c, unsigned int debut, unsigned int frequence
+		 , unsigned int total)
+{
+  c->intervalle /= total ;
+  c->bas += (unsigned long long)debut * c->intervalle ;
+  c->intervalle *= frequence ;
+  while( c->intervalle < HAUT )
+    {
+      c->intervalle <<= 8 ;
+      decale_bas(c) ;
+    }
+}
+
+/*
+ * Le décodeur fait les mêmes calculs que le codeur, en deux temps :
+ * trouver la fréquence cumulée puis retirer le symbole trouvé.
+ */
+
+static unsigned int cible(struct codeur *c, unsigned int total)
+{
+  unsigned int f ;
+
+  c->intervalle /= total ;
+  f = c->code / c->intervalle ;
+  if ( f >= total )
+    EXCEPTION_LANCE(Exception_fichier_lecture) ;
+  return f ;
+}
+
+static void decode(struct codeur *c, unsigned int debut, unsigned int frequence)
+{
+  c->code -= debut * c->intervalle ;
+  c->intervalle *= frequence ;
+  while( c->intervalle < HAUT )
+    {
+      c->code = (c->code << 8) | lit_octet(c) ;
+      c->intervalle <<= 8 ;
+    }
+}
+
+/*
+ * Codage et décodage d'une valeur après ESCAPE
+ */
+
+static unsigned int zigzag(int v)
+{
+  return v < 0 ? 2*(unsigned int)-(v+1) + 1 : 2*(unsigned int)v ;
+}
+
+static int dezigzag(unsigned int v)
+{
+  return v & 1 ? -(int)(v >> 1) - 1 : (int)(v >> 1) ;
+}
+
+static void compte_classe(struct intervalle *m, int classe)
+{
+  int i ;
+
+  m->classes[classe] += INCREMENT ;
+  m->total_classes += INCREMENT ;
+  if ( m->total_classes > TOTAL_MAX_CLASSES - INCREMENT )
+    for(m->total_classes = 0, i = 0; i < NB_CLASSES; i++)
+      {
+	m->classes[i] = (m->classes[i] + 1) / 2 ;
+	m->total_classes += m->classes[i] ;
+      }
+}
+
+static void code_escape(struct codeur *c, struct intervalle *m, int valeur)
+{
+  unsigned int z = zigzag(valeur) ;
+  int classe = nb_bits_utile(z), i, debut, nb ;
+
+  for(debut = 0, i = 0; i < classe; i++)
+    debut += m->classes[i] ;
+  code(c, debut, m->classes[classe], m->total_classes) ;
+  compte_classe(m, classe) ;
+  for(i = classe - 1; i > 0; i -= nb)
+    {
+      nb = i > 16 ? 16 : i ;
+      code(c, (z >> (i - nb)) & ((1u << nb) - 1), 1, 1u << nb) ;
+    }
+}
+
+static int decode_escape(struct codeur *c, struct intervalle *m)
+{
+  unsigned int z, f ;
+  int classe, i, debut, nb ;
+
+  f = cible(c, m->total_classes) ;
+  for(debut = 0, classe = 0; debut + m->classes[classe] <= f; classe++)
+    debut += m->classes[classe] ;
+  decode(c, debut, m->classes[classe]) ;
+  compte_classe(m, classe) ;
+  z = classe ? 1 : 0 ;
+  for(i = classe - 1; i > 0; i -= nb)
+    {
+      nb = i > 16 ? 16 : i ;
+      f = cible(c, 1u << nb) ;
+      decode(c, f, 1) ;
+      z = (z << nb) | f ;
+    }
+  return dezigzag(z) ;
+}
+
+/*
+ * Le seuil de vieillissement en tête du premier bloc
+ */
+
+static void code_seuil(struct codeur *c, struct intervalle *m)
+{
+  m->entete = Vrai ;
+  code(c, m->total_max != TOTAL_MAX, 1, 2) ;
+  if ( m->total_max != TOTAL_MAX )
+    {
+      code(c, m->total_max >> 12, 1, 1u << 11) ;
+      code(c, m->total_max & 0xFFF, 1, 1u << 12) ;
+    }
+}
+
+static void decode_seuil(struct codeur *c, struct intervalle *m)
+{
+  unsigned int f, total_max ;
+
+  m->entete = Vrai ;
+  f = cible(c, 2) ;
+  decode(c, f, 1) ;
+  if ( f == 0 )
+    total_max = TOTAL_MAX ;
+  else
+    {
+      total_max = cible(c, 1u << 11) ;
+      decode(c, total_max, 1) ;
+      f = cible(c, 1u << 12) ;
+      decode(c, f, 1) ;
+      total_max = (total_max << 12) | f ;
+      if ( total_max < 1024 || total_max > TOTAL_MAX_LIMITE )
+	EXCEPTION_LANCE(Exception_fichier_lecture) ;
+    }
+  m->total_max = total_max ;
+  m->nb_max_symboles = total_max / 4 ;
+}
+
+/*
+ * Code les "n" entiers de "v".
+ * Retourne le tableau (à libérer) des octets produits
+ * et stocke leur nombre dans "*taille".
+ */
+
+unsigned char *code_intervalle(struct intervalle *m, const int *v, size_t n
+			       , size_t *taille)
+{
+  struct codeur c ;
+  size_t i ;
+  int s, k ;
+
+  c.bas = 0 ;
+  c.intervalle = 0xFFFFFFFF ;
+  c.cache = 0 ;
+  c.nb_attente = 1 ;
+  c.premier = Vrai ;
+  c.octets = NULL ;
+  c.taille = c.taille_max = 0 ;
+
+  if ( !m->entete )
+    code_seuil(&c, m) ;
+  for(i = 0; i < n; i++)
+    {
+      s = *case_index(m, v[i]) ;
+      if ( s > ESCAPE )
+	{
+	  code(&c, cumul(m, s), m->frequences[s], m->total) ;
+	  compte(m, s) ;
+	  continue ;
+	}
+      code(&c, cumul(m, ESCAPE), m->frequences[ESCAPE], m->total) ;
+      code_escape(&c, m, v[i]) ;
+      compte(m, ESCAPE) ;
+      if ( m->nb_symboles < m->nb_max_symboles )
+	ajoute_symbole(m, v[i]) ;
+    }
+  for(k = 0; k < 5; k++)
+    decale_bas(&c) ;
+  *taille = c.taille ;
+  return c.octets ;
+}
+
+/*
+ * Décode "n" entiers dans "v" à partir des "taille" octets.
+ * Retourne le nombre d'octets utilisés.
+ */
+
+size_t decode_intervalle(struct intervalle *m, const unsigned char *octets
+			 , size_t taille, int *v, size_t n)
+{
+  struct codeur c ;
+  size_t i ;
+  int s, k, debut ;
+
+  c.intervalle = 0xFFFFFFFF ;
+  c.code = 0 ;
+  c.octets = (unsigned char*)octets ;
+  c.taille = 0 ;
+  c.taille_max = taille ;
+  for(k = 0; k < 4; k++)
+    c.code = (c.code << 8) | lit_octet(&c) ;
+
+  if ( !m->entete )
+    decode_seuil(&c, m) ;
+  for(i = 0; i < n; i++)
+    {
+      s = cherche_symbole(m, cible(&c, m->total), &debut) ;
+      decode(&c, debut, m->frequences[s]) ;
+      if ( s != ESCAPE )
+	{
+	  v[i] = m->valeurs[s] ;
+	  compte(m, s) ;
+	  continue ;
+	}
+      v[i] = decode_escape(&c, m) ;
+      compte(m, ESCAPE) ;
+      if ( m->nb_symboles < m->nb_max_symboles )
+	ajoute_symbole(m, v[i]) ;
+    }
+  return c.taille ;
+}
+
+/*
+ * Fonctions pour les tests
+ */
+
+int intervalle_get_nb_symboles(const struct intervalle *m)
+{
+  return m->nb_symboles ;
+}
+
+int intervalle_get_total(const struct intervalle *m)
+{
+  return m->total ;
+}
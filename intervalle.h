@@ -0,0 +1,23 @@
+/*
+ * Codage par intervalles (range coder) adaptatif
+ */
+
+#ifndef _HOME_EXCO_REDACTEX_COURS_TRANS_COMP_IMAGE_TP_DCT2_INTERVALLE_H
+#define _HOME_EXCO_REDACTEX_COURS_TRANS_COMP_IMAGE_TP_DCT2_INTERVALLE_H
+
+#include "bases.h"
+
+struct intervalle ;
+
+struct intervalle* open_intervalle() ;
+void vieillissement_intervalle(struct intervalle *m, int total_max) ;
+void close_intervalle(struct intervalle *m) ;
+unsigned char *code_intervalle(struct intervalle *m, const int *v, size_t n, size_t *taille) ;
+size_t decode_intervalle(struct intervalle *m, const unsigned char *octets, size_t taille, int *v, size_t n) ;
+
+/* Pour les tests */
+
+int intervalle_get_nb_symboles(const struct intervalle *m) ; /**/
+int intervalle_get_total(const struct intervalle *m) ; /**/
+
+#endif
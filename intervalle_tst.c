@@ -0,0 +1,197 @@
+#include "intervalle.h"
+#include "exception.h"
+
+void open_intervalle_tst()
+{
+  struct intervalle *m ;
+
+  m = open_intervalle() ;
+  if ( m == NULL )
+    {
+      eprintf("Elle retourne NULL !\n") ;
+      return ;
+    }
+  if ( intervalle_get_nb_symboles(m) != 1 )
+    {
+      eprintf("Au départ il n'y a que le symbole ESCAPE\n") ;
+      return ;
+    }
+  close_intervalle(m) ;
+}
+
+void close_intervalle_tst()
+{
+  struct intervalle *m, *m2 ;
+
+  m = open_intervalle() ;
+  close_intervalle(m) ;
+  m2 = open_intervalle() ;
+  if ( m != m2 )
+    {
+      eprintf("Vous oubliez de libérer quelque chose\n") ;
+      return ;
+    }
+  close_intervalle(m2) ;
+}
+
+/*
+ * 20000 entiers dont 90% de 0 : l'entropie est de 0.63 bit par entier,
+ * on accepte quelques octets de plus pour apprendre.
+ */
+
+/*
+ * Avec un petit seuil le total reste petit, le décodeur
+ * avec le même seuil retrouve les valeurs.
+ * Une longue suite de 0 puis de 1 : le grand seuil apprend trop
+ * lentement le changement, le petit doit coder plus court.
+ */
+
+void vieillissement_intervalle_tst()
+{
+  static int v[200000], w[200000] ;
+  struct intervalle *m ;
+  unsigned char *octets ;
+  size_t taille, taille_grand ;
+  int i ;
+
+  for(i=0; i<TAILLE(v); i++)
+    v[i] = i < TAILLE(v)/2 ? rand() % 50 == 0 : rand() % 50 != 0 ;
+
+  m = open_intervalle() ;
+  vieillissement_intervalle(m, 1 << 22) ;
+  octets = code_intervalle(m, v, TAILLE(v), &taille_grand) ;
+  free(octets) ;
+  close_intervalle(m) ;
+
+  m = open_intervalle() ;
+  vieillissement_intervalle(m, 4096) ;
+  octets = code_intervalle(m, v, TAILLE(v), &taille) ;
+  if ( intervalle_get_total(m) > 4096 )
+    {
+      eprintf("Le total %d dépasse le seuil\n", intervalle_get_total(m)) ;
+      return ;
+    }
+  close_intervalle(m) ;
+  if ( taille >= taille_grand )
+    {
+      eprintf("Seuil 4096 : %lu octets, seuil 2^22 : %lu octets\n"
+	      , (unsigned long)taille, (unsigned long)taille_grand) ;
+      return ;
+    }
+
+  /* Le seuil est lu dans le flot */
+  m = open_intervalle() ;
+  if ( decode_intervalle(m, octets, taille, w, TAILLE(w)) != taille
+       || memcmp(v, w, sizeof(v)) )
+    {
+      eprintf("Mauvais décodage avec le seuil 4096\n") ;
+      return ;
+    }
+  if ( intervalle_get_total(m) > 4096 )
+    {
+      eprintf("Le décodeur n'a pas lu le seuil\n") ;
+      return ;
+    }
+  close_intervalle(m) ;
+  free(octets) ;
+}
+
+void code_intervalle_tst()
+{
+  static int v[20000] ;
+  struct intervalle *m ;
+  unsigned char *octets ;
+  size_t taille ;
+  int i ;
+
+  for(i=0; i<TAILLE(v); i++)
+    v[i] = rand() % 10 ? 0 : 1 + rand() % 3 ;
+  m = open_intervalle() ;
+  octets = code_intervalle(m, v, TAILLE(v), &taille) ;
+  free(octets) ;
+  if ( intervalle_get_nb_symboles(m) != 5 )
+    {
+      eprintf("Il devrait y avoir 4 valeurs et ESCAPE dans le modèle\n") ;
+      return ;
+    }
+  if ( intervalle_get_total(m) > 1 << 18 )
+    {
+      eprintf("Le total des fréquences n'est pas limité\n") ;
+      return ;
+    }
+  if ( taille > 20000 * 0.65 / 8 )
+    {
+      eprintf("%lu octets, c'est trop\n", (unsigned long)taille) ;
+      return ;
+    }
+  close_intervalle(m) ;
+}
+
+void decode_intervalle_tst()
+{
+  static int v[40000], w[40000+1] ;
+  struct intervalle *codeur, *decodeur ;
+  unsigned char *octets = NULL ;
+  size_t taille, n ;
+  int i, j, r ;
+
+  for(j=0; j<4; j++)
+    {
+      for(i=0; i<TAILLE(v); i++)
+	switch(j)
+	  {
+	  case 0: v[i] = rand() % 20 - 10 ; break ;
+	  case 1: v[i] = rand() - RAND_MAX/2 ; break ; /* Plein de ESCAPE */
+	  case 2: v[i] = i % 300 == 0 ? (int)0x80000000 : rand() % 3 ; break ;
+	  case 3: v[i] = i < 20000 ? i % 7 : 1000 + i % 5 ; break ;
+	  }
+      /*
+       * Plusieurs blocs de suite avec les mêmes modèles
+       */
+      codeur = open_intervalle() ;
+      decodeur = open_intervalle() ;
+      for(n=0; n<TAILLE(v); n += n < 20 ? 1 : 9999)
+	{
+	  octets = code_intervalle(codeur, v, n, &taille) ;
+	  w[n] = 1234 ;
+	  if ( decode_intervalle(decodeur, octets, taille, w, n) != taille )
+	    {
+	      eprintf("Le décodage de %lu entiers n'utilise pas tout\n"
+		      , (unsigned long)n) ;
+	      return ;
+	    }
+	  free(octets) ;
+	  if ( memcmp(v, w, n*sizeof(*v)) || w[n] != 1234 )
+	    {
+	      eprintf("Mauvais décodage de %lu entiers (cas %d)\n"
+		      , (unsigned long)n, j) ;
+	      return ;
+	    }
+	}
+      close_intervalle(codeur) ;
+      close_intervalle(decodeur) ;
+    }
+
+  /*
+   * Un flot tronqué
+   */
+  codeur = open_intervalle() ;
+  decodeur = open_intervalle() ;
+  octets = code_intervalle(codeur, v, 1000, &taille) ;
+  r = 0 ;
+  EXCEPTION(decode_intervalle(decodeur, octets, taille/2, w, 1000) ;
+	    ,
+	    ,
+	    case Exception_fichier_lecture:
+	    r = 1 ;
+	    break ;
+	    ) ;
+  free(octets) ;
+  close_intervalle(codeur) ;
+  close_intervalle(decodeur) ;
+  if ( r != 1 )
+    {
+      eprintf("Pas d'exception sur un flot tronqué\n") ;
+      return ;
+    }
+}
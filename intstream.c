@@ -1,14 +1,209 @@
 #include "intstream.h"
 #include "sf.h"
 #include "entier.h"
+#include "golomb.h"
+#include "vbyte.h"
+#include "huffman.h"
+#include "intervalle.h"
+#include "rans.h"
+#include "vitter.h"
+#include "exception.h"
+#include "bits.h"
 
 struct intstream
 {
   enum intstream_type type ;
   struct bitstream *bitstream ;           /* Dans tous les cas, le bitstream */
   struct shannon_fano *shannon_fano ;     /* Si type==Shanno_fano */
+  struct golomb *golomb ;		  /* Si type==Golomb(_Signe) */
+  struct intervalle *intervalle ;	  /* Si type==Intervalle */
+  struct vitter *vitter ;		  /* Si type==Vitter */
+  Booleen separe ;			  /* Flot de bits en mémoire */
+  Booleen ecriture ;			  /* Si séparé */
+  unsigned char *octets ;		  /* Octets de la trame lue */
+  size_t taille_octets ;		  /* Taille allouée de "octets" */
+  int *entiers ;			  /* Entiers de la trame si par bloc */
+  size_t nb_entiers ;			  /* Nombre d'entiers de la trame */
+  size_t taille_entiers ;		  /* Taille allouée de "entiers" */
+  size_t position_entiers ;		  /* Prochain entier lu */
 } ;
 
+/*
+ * Les types qui codent tous les entiers d'une trame en une fois.
+ * Les entiers sont stockés dans "entiers" jusqu'à "ecrit_trame_intstreams"
+ * et décodés d'un coup par "lit_trame_intstreams".
+ * Ils ne peuvent donc être utilisés que dans un "intstream" séparé.
+ */
+
+Booleen intstream_type_par_bloc(enum intstream_type type)
+{
+  switch(type)
+    {
+    case Vbyte:
+    case Vbyte_Signe:
+    case Huffman_canonique:
+    case Huffman_canonique_Signe:
+    case Intervalle:
+    case Rans:
+    case Rans_Signe:
+      return Vrai ;
+    default:
+      return Faux ;
+    }
+}
+
+/*
+ * Les entiers signés sont entrelacés : 0 -1 1 -2 2 ... deviennent 0 1 2 3 4
+ */
+
+static int zigzag(int v)
+{
+  return v < 0 ? 2*(unsigned int)-(v+1) + 1 : 2*(unsigned int)v ;
+}
+
+static int dezigzag(int v)
+{
+  return v & 1 ? -(int)((unsigned int)v >> 1) - 1 : (int)((unsigned int)v >> 1) ;
+}
+
+/*
+ * Fait de la place pour "n" entiers de plus
+ */
+
+static void agrandit_entiers(struct intstream *is, size_t n)
+{
+  if ( is->nb_entiers + n <= is->taille_entiers )
+    return ;
+  is->taille_entiers = 2*is->taille_entiers ;
+  if ( is->taille_entiers < is->nb_entiers + n )
+    is->taille_entiers = is->nb_entiers + n ;
+  if ( is->taille_entiers < 1024 )
+    is->taille_entiers = 1024 ;
+  is->entiers = realloc(is->entiers, is->taille_entiers*sizeof(*is->entiers)) ;
+  if ( is->entiers == NULL )
+    {
+      fprintf(stderr, "Plus de memoire\n") ;
+      EXIT ;
+    }
+}
+
+/*
+ * Lit le nombre d'entiers en tête d'une trame de "taille" octets
+ * et fait leur place. Un entier coûte au moins 1/"nb_par_octet" octet :
+ * une trame trop petite ou un nombre qu'elle ne peut pas contenir
+ * est refusé.
+ */
+
+static size_t lit_nb_entiers(struct intstream *is, size_t taille
+			     , size_t nb_par_octet)
+{
+  size_t n ;
+
+  if ( taille < 4 )
+    EXCEPTION_LANCE(Exception_fichier_lecture) ;
+  n = get_bits(is->bitstream, 32) ;
+  if ( n > (taille - 4) * nb_par_octet )
+    EXCEPTION_LANCE(Exception_fichier_lecture) ;
+  is->nb_entiers = 0 ;
+  agrandit_entiers(is, n) ;
+  return n ;
+}
+
+/*
+ * Codage des entiers de la trame dans le flot en mémoire.
+ */
+
+static void vide_intstream(struct intstream *is)
+{
+  unsigned char *octets ;
+  size_t taille ;
+
+  switch(is->type)
+    {
+    case Vbyte:
+    case Vbyte_Signe:
+      put_bits(is->bitstream, 32, is->nb_entiers) ;
+      ALLOUER(octets, taille_max_vbyte(is->nb_entiers) + 1) ;
+      taille = code_vbyte((unsigned int*)is->entiers, is->nb_entiers, octets) ;
+      put_octets(is->bitstream, octets, taille) ;
+      free(octets) ;
+      break ;
+    case Huffman_canonique:
+    case Huffman_canonique_Signe:
+      put_bits(is->bitstream, 32, is->nb_entiers) ;
+      put_huffman(is->bitstream, (unsigned int*)is->entiers, is->nb_entiers) ;
+      break ;
+    case Rans:
+    case Rans_Signe:
+      put_bits(is->bitstream, 32, is->nb_entiers) ;
+      put_rans(is->bitstream, (unsigned int*)is->entiers, is->nb_entiers) ;
+      break ;
+    case Intervalle:
+      put_bits(is->bitstream, 32, is->nb_entiers) ;
+      octets = code_intervalle(is->intervalle, is->entiers, is->nb_entiers
+			       , &taille) ;
+      put_octets(is->bitstream, octets, taille) ;
+      free(octets) ;
+      break ;
+    default:
+      break ;
+    }
+  is->nb_entiers = 0 ;
+}
+
+/*
+ * Décodage des entiers de la trame qui vient d'être lue
+ * dans les "taille" octets de "is->octets".
+ */
+
+static void remplit_intstream(struct intstream *is, size_t taille)
+{
+  size_t n ;
+
+  switch(is->type)
+    {
+    case Vbyte:
+    case Vbyte_Signe:
+      n = lit_nb_entiers(is, taille, 1) ;
+      decode_vbyte(is->octets + 4, taille - 4, (unsigned int*)is->entiers, n) ;
+      break ;
+    case Huffman_canonique:
+    case Huffman_canonique_Signe:
+      n = lit_nb_entiers(is, taille, 8) ; /* Au moins un bit par entier */
+      get_huffman(is->bitstream, (unsigned int*)is->entiers, n) ;
+      break ;
+    case Rans:
+    case Rans_Signe:
+      /* Probabilité au plus 4095/4096 : plus de 2^-12 bit par entier */
+      n = lit_nb_entiers(is, taille, (size_t)8 << 12) ;
+      get_rans(is->bitstream, (unsigned int*)is->entiers, n) ;
+      break ;
+    case Intervalle:
+      /* Fréquence au plus "total - 1" avec un total au plus 2^22 :
+       * un entier coûte plus de 2^-22 bit.
+       */
+      n = lit_nb_entiers(is, taille, (size_t)8 << 22) ;
+      decode_intervalle(is->intervalle, is->octets + 4, taille - 4
+			, is->entiers, n) ;
+      break ;
+    default:
+      return ;
+    }
+  is->nb_entiers = n ;
+  is->position_entiers = 0 ;
+}
+
+/*
+ * Le prochain entier de la trame décodée
+ */
+
+static int prend_entier(struct intstream *is)
+{
+  if ( is->position_entiers == is->nb_entiers )
+    EXCEPTION_LANCE(Exception_fichier_lecture) ;
+  return is->entiers[is->position_entiers++] ;
+}
+
 
 struct intstream* open_intstream(struct bitstream *bitstream
 				 , enum intstream_type type
@@ -19,6 +214,13 @@ struct intstream* open_intstream(struct bitstream *bitstream
   ALLOUER(is, 1) ;
   is->bitstream = bitstream ;
   is->type = type ;
+  is->separe = Faux ;
+  is->octets = NULL ;
+  is->taille_octets = 0 ;
+  is->entiers = NULL ;
+  is->nb_entiers = 0 ;
+  is->taille_entiers = 0 ;
+  is->position_entiers = 0 ;
 
   if ( type == Shannon_fano )
     {
@@ -26,15 +228,245 @@ struct intstream* open_intstream(struct bitstream *bitstream
 	EXIT ;
       is->shannon_fano = shannon_fano ;
     }
+  if ( type == Golomb || type == Golomb_Signe )
+    is->golomb = open_golomb() ;
+  if ( type == Intervalle )
+    is->intervalle = open_intervalle() ;
+  if ( type == Vitter )
+    is->vitter = open_vitter() ;
+  if ( intstream_type_par_bloc(type) && bitstream != NULL )
+    {
+      fprintf(stderr, "Ce type d'intstream doit être séparé\n") ;
+      EXIT ;
+    }
 
   return(is) ;
 }
 
+void put_entiers_intstream(struct intstream *is, const int *v, size_t n)
+{
+  size_t i ;
+
+  switch(is->type)
+    {
+    case Shannon_fano:
+      for(i=0; i<n; i++)
+	put_entier_shannon_fano(is->bitstream, is->shannon_fano, v[i]) ;
+      break ;
+    case Entier:
+      for(i=0; i<n; i++)
+	put_entier(is->bitstream, v[i]) ;
+      break ;
+    case Entier_Signe:
+      for(i=0; i<n; i++)
+	put_entier_signe(is->bitstream, v[i]) ;
+      break ;
+    case Golomb:
+      for(i=0; i<n; i++)
+	put_entier_golomb(is->bitstream, is->golomb, v[i]) ;
+      break ;
+    case Golomb_Signe:
+      for(i=0; i<n; i++)
+	put_entier_signe_golomb(is->bitstream, is->golomb, v[i]) ;
+      break ;
+    case Vitter:
+      for(i=0; i<n; i++)
+	put_entier_vitter(is->bitstream, is->vitter, v[i]) ;
+      break ;
+    case Vbyte:
+    case Huffman_canonique:
+    case Intervalle:
+    case Rans:
+      agrandit_entiers(is, n) ;
+      memcpy(is->entiers + is->nb_entiers, v, n*sizeof(*v)) ;
+      is->nb_entiers += n ;
+      break ;
+    case Vbyte_Signe:
+    case Huffman_canonique_Signe:
+    case Rans_Signe:
+      agrandit_entiers(is, n) ;
+      for(i=0; i<n; i++)
+	is->entiers[is->nb_entiers++] = zigzag(v[i]) ;
+      break ;
+    default:
+      EXIT ;
+    }
+}
+
+void get_entiers_intstream(struct intstream *is, int *v, size_t n)
+{
+  size_t i ;
+
+  switch(is->type)
+    {
+    case Shannon_fano:
+      for(i=0; i<n; i++)
+	v[i] = get_entier_shannon_fano(is->bitstream, is->shannon_fano) ;
+      break ;
+    case Entier:
+      for(i=0; i<n; i++)
+	v[i] = get_entier(is->bitstream) ;
+      break ;
+    case Entier_Signe:
+      for(i=0; i<n; i++)
+	v[i] = get_entier_signe(is->bitstream) ;
+      break ;
+    case Golomb:
+      for(i=0; i<n; i++)
+	v[i] = get_entier_golomb(is->bitstream, is->golomb) ;
+      break ;
+    case Golomb_Signe:
+      for(i=0; i<n; i++)
+	v[i] = get_entier_signe_golomb(is->bitstream, is->golomb) ;
+      break ;
+    case Vitter:
+      for(i=0; i<n; i++)
+	v[i] = get_entier_vitter(is->bitstream, is->vitter) ;
+      break ;
+    case Vbyte:
+    case Huffman_canonique:
+    case Intervalle:
+    case Rans:
+      if ( is->position_entiers + n > is->nb_entiers )
+	EXCEPTION_LANCE(Exception_fichier_lecture) ;
+      memcpy(v, is->entiers + is->position_entiers, n*sizeof(*v)) ;
+      is->position_entiers += n ;
+      break ;
+    case Vbyte_Signe:
+    case Huffman_canonique_Signe:
+    case Rans_Signe:
+      if ( is->position_entiers + n > is->nb_entiers )
+	EXCEPTION_LANCE(Exception_fichier_lecture) ;
+      for(i=0; i<n; i++)
+	v[i] = dezigzag(is->entiers[is->position_entiers++]) ;
+      break ;
+    default:
+      EXIT ;
+    }
+}
+
+Booleen intstream_separe(const struct intstream *is)
+{
+  return is->separe ;
+}
+
+/*
+ * Le flot en mémoire est vide jusqu'à la première trame,
+ * en lecture il ne contient aucun octet.
+ */
+
+struct intstream* open_intstream_separe(const char *mode
+					, enum intstream_type type
+					, struct shannon_fano *shannon_fano)
+{
+  struct intstream *is ;
+
+  is = open_intstream(NULL, type, shannon_fano) ;
+  is->separe = Vrai ;
+  is->ecriture = *mode != 'r' ;
+  if ( is->ecriture )
+    is->bitstream = open_bitstream_memory(NULL, 0) ;
+  else
+    is->bitstream = open_bitstream_memory_read(NULL, 0) ;
+
+  return(is) ;
+}
+
+void vieillissement_intstream(struct intstream *is, int total_max)
+{
+  if ( is->type == Intervalle )
+    vieillissement_intervalle(is->intervalle, total_max) ;
+}
+
 void close_intstream(struct intstream *is)
 {
+  if ( is->type == Golomb || is->type == Golomb_Signe )
+    close_golomb(is->golomb) ;
+  if ( is->type == Intervalle )
+    close_intervalle(is->intervalle) ;
+  if ( is->type == Vitter )
+    close_vitter(is->vitter) ;
+  if ( is->separe )
+    {
+      close_bitstream(is->bitstream) ;
+      free(is->octets) ;
+    }
+  free(is->entiers) ;
   free(is) ;
 }
 
+/*
+ * Ecrit dans "bs" la trame des "nb" intstream séparés :
+ *    - la taille en octets de chaque flot (32 bits),
+ *    - des 0 jusqu'à la frontière d'octet,
+ *    - les octets de chaque flot, dans le même ordre.
+ * L'alignement permet de recopier les octets d'un coup.
+ * Les flots en mémoire sont ensuite vidés pour la trame suivante.
+ * Les modèles (Shannon-Fano...) ne sont pas remis à zéro.
+ */
+
+void ecrit_trame_intstreams(struct bitstream *bs, struct intstream **is, int nb)
+{
+  unsigned char **octets ;
+  size_t *taille ;
+  int i ;
+
+  ALLOUER(octets, nb) ;
+  ALLOUER(taille, nb) ;
+  for(i=0; i<nb; i++)
+    {
+      if ( !is[i]->separe || !is[i]->ecriture )
+	EXIT ;
+      vide_intstream(is[i]) ;
+      octets[i] = bitstream_memory(is[i]->bitstream, &taille[i]) ;
+      put_bits(bs, 32, taille[i]) ;
+    }
+  aligne_bitstream(bs) ;
+  for(i=0; i<nb; i++)
+    {
+      put_octets(bs, octets[i], taille[i]) ;
+      close_bitstream(is[i]->bitstream) ;
+      is[i]->bitstream = open_bitstream_memory(NULL, taille[i]) ;
+    }
+  free(octets) ;
+  free(taille) ;
+}
+
+/*
+ * Lit dans "bs" une trame écrite par "ecrit_trame_intstreams"
+ * avec le même nombre d'intstream.
+ * Chaque intstream lit ensuite les entiers de son propre flot.
+ */
+
+void lit_trame_intstreams(struct bitstream *bs, struct intstream **is, int nb)
+{
+  size_t *taille ;
+  int i ;
+
+  ALLOUER(taille, nb) ;
+  for(i=0; i<nb; i++)
+    {
+      if ( !is[i]->separe || is[i]->ecriture )
+	EXIT ;
+      taille[i] = get_bits(bs, 32) ;
+    }
+  aligne_bitstream(bs) ;
+  for(i=0; i<nb; i++)
+    {
+      if ( taille[i] > is[i]->taille_octets )
+	{
+	  free(is[i]->octets) ;
+	  ALLOUER(is[i]->octets, taille[i]) ;
+	  is[i]->taille_octets = taille[i] ;
+	}
+      get_octets(bs, is[i]->octets, taille[i]) ;
+      close_bitstream(is[i]->bitstream) ;
+      is[i]->bitstream = open_bitstream_memory_read(is[i]->octets, taille[i]) ;
+      remplit_intstream(is[i], taille[i]) ;
+    }
+  free(taille) ;
+}
+
 void put_entier_intstream(struct intstream *is, int evenement)
 {
   switch(is->type)
@@ -48,6 +480,28 @@ void put_entier_intstream(struct intstream *is, int evenement)
     case Entier_Signe:
       put_entier_signe(is->bitstream, evenement) ;
       break ;
+    case Golomb:
+      put_entier_golomb(is->bitstream, is->golomb, evenement) ;
+      break ;
+    case Golomb_Signe:
+      put_entier_signe_golomb(is->bitstream, is->golomb, evenement) ;
+      break ;
+    case Vitter:
+      put_entier_vitter(is->bitstream, is->vitter, evenement) ;
+      break ;
+    case Vbyte:
+    case Huffman_canonique:
+    case Intervalle:
+    case Rans:
+      agrandit_entiers(is, 1) ;
+      is->entiers[is->nb_entiers++] = evenement ;
+      break ;
+    case Vbyte_Signe:
+    case Huffman_canonique_Signe:
+    case Rans_Signe:
+      agrandit_entiers(is, 1) ;
+      is->entiers[is->nb_entiers++] = zigzag(evenement) ;
+      break ;
     default:
       EXIT ;
     }
@@ -63,6 +517,21 @@ int get_entier_intstream(struct intstream *is)
       return( get_entier(is->bitstream) ) ;
     case Entier_Signe:
       return( get_entier_signe(is->bitstream) ) ;
+    case Golomb:
+      return( get_entier_golomb(is->bitstream, is->golomb) ) ;
+    case Golomb_Signe:
+      return( get_entier_signe_golomb(is->bitstream, is->golomb) ) ;
+    case Vitter:
+      return( get_entier_vitter(is->bitstream, is->vitter) ) ;
+    case Vbyte:
+    case Huffman_canonique:
+    case Intervalle:
+    case Rans:
+      return( prend_entier(is) ) ;
+    case Vbyte_Signe:
+    case Huffman_canonique_Signe:
+    case Rans_Signe:
+      return( dezigzag(prend_entier(is)) ) ;
     default:
       EXIT ;
     }
@@ -5,6 +5,9 @@
 #ifndef _HOME_EXCO_REDACTEX_COURS_TRANS_COMP_IMAGE_TP_DCT2_INTSTREAM_H
 #define _HOME_EXCO_REDACTEX_COURS_TRANS_COMP_IMAGE_TP_DCT2_INTSTREAM_H
 
+#include "bases.h"
+#include "bit.h"
+
 struct bitstream ;
 struct shannon_fano ;
 struct intstream ;
@@ -20,6 +23,16 @@ enum intstream_type
 {  Entier
   ,Entier_Signe
   ,Shannon_fano
+  ,Golomb			/* Golomb-Rice adaptatif, sans limite */
+  ,Golomb_Signe
+  ,Vbyte			/* Octets, très rapide : séparé seulement */
+  ,Vbyte_Signe
+  ,Huffman_canonique		/* Huffman en deux passes : séparé seulement */
+  ,Huffman_canonique_Signe
+  ,Intervalle			/* Codage arithmétique : séparé seulement */
+  ,Rans				/* rANS par bloc : séparé seulement */
+  ,Rans_Signe
+  ,Vitter			/* Huffman adaptatif de Vitter */
 } ;
 
 /*
@@ -33,7 +46,44 @@ struct intstream* open_intstream(struct bitstream *bitstream
  * car ils n'ont pas été créé par "open_intstream"
  */
 void        close_intstream(struct intstream *is) ;
+/*
+ * Un "intstream" séparé écrit dans son propre flot de bits en mémoire
+ * au lieu de partager le "bitstream" des autres.
+ * "mode" est "w" ou "r" comme pour "open_bitstream".
+ *
+ * Les flots de plusieurs "intstream" séparés sont regroupés dans une
+ * trame : la taille en octets de chacun puis leurs octets à la suite.
+ * Chaque "intstream" peut ensuite être relu indépendamment des autres.
+ * Il faut écrire la trame avant de fermer les "intstream".
+ */
+struct intstream* open_intstream_separe(const char *mode
+					, enum intstream_type type
+					, struct shannon_fano *shannon_fano) ;
+void ecrit_trame_intstreams(struct bitstream *bs, struct intstream **is, int nb) ;
+void   lit_trame_intstreams(struct bitstream *bs, struct intstream **is, int nb) ;
+
 void   put_entier_intstream(struct intstream *is, int evenement) ;
 int    get_entier_intstream(struct intstream *is) ;
+/*
+ * Ecriture et lecture de "n" entiers d'un coup,
+ * le type est testé une seule fois pour tout le tableau.
+ */
+void  put_entiers_intstream(struct intstream *is, const int *v, size_t n) ;
+void  get_entiers_intstream(struct intstream *is, int *v, size_t n) ;
+/*
+ * Vrai si l'intstream a son propre flot de bits : ses entiers
+ * peuvent être lus et écrits sans alterner avec ceux des autres.
+ */
+Booleen     intstream_separe(const struct intstream *is) ;
+/*
+ * Vrai si le type code les entiers par trame : il faut un "intstream" séparé.
+ */
+Booleen     intstream_type_par_bloc(enum intstream_type type) ;
+/*
+ * Seuil de division des fréquences du modèle créé par "open_intstream"
+ * (type Intervalle seulement, sans effet pour les autres).
+ * A appeler avant le premier entier, le seuil est écrit dans le flot.
+ */
+void        vieillissement_intstream(struct intstream *is, int total_max) ;
 
 #endif
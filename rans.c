@@ -0,0 +1,304 @@
+#include "rans.h"
+#include "bits.h"
+#include "exception.h"
+
+/*
+ * Codage rANS (range Asymmetric Numeral Systems) d'un bloc d'entiers.
+ *
+ * Comme pour "huffman.c", on compte d'abord les symboles du bloc
+ * (mêmes symboles : les entiers inférieurs à NB_DIRECT, sinon une
+ * classe de taille suivie des bits sans le premier 1).
+ * Les nombres d'occurrences sont ramenés à des fréquences de
+ * somme TOTAL_RANS, transmises dans l'en-tête.
+ *
+ * Un état "x" (32 bits) code un symbole de fréquence "f" commençant
+ * au cumul "debut" par : x = (x / f) * TOTAL_RANS + debut + x % f.
+ * Le décodeur retrouve le symbole dans les bits de poids faible de x
+ * et revient à l'état précédent : le décodage se fait donc dans
+ * l'ordre inverse du codage, le codeur part de la fin du bloc
+ * et écrit ses octets de la fin vers le début.
+ * L'état reste entre BAS_RANS et 256*BAS_RANS en sortant
+ * (ou en lisant) des octets.
+ *
+ * Le symbole "i" est codé avec l'état "i % NB_ETATS" : les calculs
+ * des quatre états sont indépendants et le processeur
+ * les fait en parallèle.
+ *
+ * Format d'un bloc :
+ *    - les fréquences (voir "ecrit_frequences"),
+ *    - le nombre d'octets rANS sur 32 bits, puis ces octets
+ *      (les états finaux du codeur puis les octets sortis),
+ *    - les bits en plus des grands entiers, dans l'ordre.
+ */
+
+#define NB_DIRECT 256
+#define NB_SYMBOLES (NB_DIRECT + 24)
+#define BITS_RANS 12
+#define TOTAL_RANS (1u << BITS_RANS)
+#define BAS_RANS (1u << 23)
+#define NB_ETATS 4
+
+struct table_rans
+{
+  unsigned int frequence[NB_SYMBOLES] ;
+  unsigned int debut[NB_SYMBOLES] ;
+  unsigned short symbole[TOTAL_RANS] ; /* Symbole de chaque cumul */
+} ;
+
+static int symbole(unsigned int v)
+{
+  if ( v < NB_DIRECT )
+    return v ;
+  return NB_DIRECT + nb_bits_utile(v) - 9 ;
+}
+
+static int nb_bits_en_plus(int s)
+{
+  return s < NB_DIRECT ? 0 : s - NB_DIRECT + 8 ;
+}
+
+/*
+ * Fréquences proportionnelles aux nombres d'occurrences,
+ * de somme "total", et non nulles pour les symboles présents.
+ * L'arrondi est corrigé sur les symboles les plus fréquents.
+ */
+
+void normalise_frequences(const unsigned int *nb_occurrences, int nb_symboles
+			  , unsigned int total, unsigned int *frequences)
+{
+  unsigned long long nb = 0 ;
+  long somme = 0, difference ;
+  int s, plus_grand ;
+
+  for(s = 0; s < nb_symboles; s++)
+    nb += nb_occurrences[s] ;
+  if ( nb == 0 )
+    {
+      memset(frequences, 0, nb_symboles * sizeof(*frequences)) ;
+      return ;
+    }
+  for(plus_grand = 0, s = 0; s < nb_symboles; s++)
+    {
+      frequences[s] = (nb_occurrences[s] * (unsigned long long)total
+		       + nb/2) / nb ;
+      if ( nb_occurrences[s] && frequences[s] == 0 )
+	frequences[s] = 1 ;
+      somme += frequences[s] ;
+      if ( frequences[s] > frequences[plus_grand] )
+	plus_grand = s ;
+    }
+
+  difference = (long)total - somme ;
+  if ( difference >= 0 || (long)frequences[plus_grand] + difference > 0 )
+    {
+      frequences[plus_grand] += difference ;
+      return ;
+    }
+  /* Trop de symboles rares : on prend un à chacun des plus fréquents */
+  while( difference < 0 )
+    for(s = 0; s < nb_symboles && difference < 0; s++)
+      if ( frequences[s] > 1 )
+	{
+	  frequences[s]-- ;
+	  difference++ ;
+	}
+}
+
+/*
+ * En-tête : le nombre de symboles transmis sur 9 bits, puis pour
+ * chaque symbole le nombre de bits de sa fréquence sur 4 bits
+ * et ses bits sans le premier 1. Une fréquence nulle est suivie
+ * sur 5 bits du nombre de fréquences nulles qui la suivent.
+ */
+
+static void ecrit_frequences(struct bitstream *bs, const unsigned int *f)
+{
+  int s, nb, n, l ;
+
+  for(nb = NB_SYMBOLES; nb > 0 && f[nb-1] == 0; nb--)
+    ;
+  put_bits(bs, 9, nb) ;
+  for(s = 0; s < nb; s++)
+    {
+      l = nb_bits_utile(f[s]) ;
+      put_bits(bs, 4, l) ;
+      if ( l > 1 )
+	put_bits(bs, l - 1, f[s]) ;
+      if ( l == 0 )
+	{
+	  for(n = 0; n < 31 && s + 1 < nb && f[s+1] == 0; n++)
+	    s++ ;
+	  put_bits(bs, 5, n) ;
+	}
+    }
+}
+
+static void lit_frequences(struct bitstream *bs, struct table_rans *t)
+{
+  unsigned int debut ;
+  int s, nb, n, l ;
+
+  nb = get_bits(bs, 9) ;
+  if ( nb > NB_SYMBOLES )
+    EXCEPTION_LANCE(Exception_fichier_lecture) ;
+  memset(t->frequence, 0, sizeof(t->frequence)) ;
+  for(s = 0; s < nb; s++)
+    {
+      l = get_bits(bs, 4) ;
+      if ( l > BITS_RANS + 1 )
+	EXCEPTION_LANCE(Exception_fichier_lecture) ;
+      if ( l )
+	t->frequence[s] = pow2(l - 1) | (l > 1 ? get_bits(bs, l - 1) : 0) ;
+      else
+	{
+	  n = get_bits(bs, 5) ;
+	  if ( s + n >= nb )
+	    EXCEPTION_LANCE(Exception_fichier_lecture) ;
+	  s += n ;
+	}
+    }
+
+  for(debut = 0, s = 0; s < NB_SYMBOLES; s++)
+    {
+      t->debut[s] = debut ;
+      if ( debut + t->frequence[s] > TOTAL_RANS )
+	EXCEPTION_LANCE(Exception_fichier_lecture) ;
+      for(n = 0; n < t->frequence[s]; n++)
+	t->symbole[debut + n] = s ;
+      debut += t->frequence[s] ;
+    }
+  if ( debut != TOTAL_RANS )
+    EXCEPTION_LANCE(Exception_fichier_lecture) ;
+}
+
+/*
+ * Ecrit les "n" entiers de "v". Le nombre d'entiers n'est pas écrit.
+ */
+
+void put_rans(struct bitstream *bs, const unsigned int *v, size_t n)
+{
+  unsigned int nb_occurrences[NB_SYMBOLES], frequence[NB_SYMBOLES] ;
+  unsigned int debut[NB_SYMBOLES] ;
+  unsigned int x[NB_ETATS], x_max, f ;
+  unsigned char *octets, *p ;
+  size_t i ;
+  int s, k ;
+
+  if ( n == 0 )
+    return ;
+  memset(nb_occurrences, 0, sizeof(nb_occurrences)) ;
+  for(i = 0; i < n; i++)
+    nb_occurrences[symbole(v[i])]++ ;
+  normalise_frequences(nb_occurrences, NB_SYMBOLES, TOTAL_RANS, frequence) ;
+  /*
+   * Un symbole seul ne coûterait rien : il laisse une place à un voisin,
+   * pour qu'un entier coûte toujours plus de 2^-BITS_RANS bit
+   * et que le décodeur puisse borner la taille d'un bloc.
+   */
+  for(s = 0; s < NB_SYMBOLES; s++)
+    if ( frequence[s] == TOTAL_RANS )
+      {
+	frequence[s]-- ;
+	frequence[s ? s - 1 : 1]++ ;
+      }
+  for(debut[0] = 0, s = 1; s < NB_SYMBOLES; s++)
+    debut[s] = debut[s-1] + frequence[s-1] ;
+  ecrit_frequences(bs, frequence) ;
+
+  /*
+   * Au plus BITS_RANS bits (donc 2 octets) par symbole
+   * et les états finaux.
+   */
+  ALLOUER(octets, 2*n + 4*NB_ETATS) ;
+  p = octets + 2*n + 4*NB_ETATS ;
+  for(k = 0; k < NB_ETATS; k++)
+    x[k] = BAS_RANS ;
+  for(i = n; i-- > 0; )
+    {
+      s = symbole(v[i]) ;
+      f = frequence[s] ;
+      k = i % NB_ETATS ;
+      x_max = ((BAS_RANS >> BITS_RANS) << 8) * f ;
+      while( x[k] >= x_max )
+	{
+	  *--p = x[k] ;
+	  x[k] >>= 8 ;
+	}
+      x[k] = ((x[k] / f) << BITS_RANS) + x[k] % f + debut[s] ;
+    }
+  for(k = NB_ETATS; k-- > 0; )
+    {
+      p -= 4 ;
+      p[0] = x[k] ; p[1] = x[k] >> 8 ; p[2] = x[k] >> 16 ; p[3] = x[k] >> 24 ;
+    }
+  put_bits(bs, 32, octets + 2*n + 4*NB_ETATS - p) ;
+  put_octets(bs, p, octets + 2*n + 4*NB_ETATS - p) ;
+  free(octets) ;
+
+  for(i = 0; i < n; i++)
+    if ( (s = symbole(v[i])) >= NB_DIRECT )
+      put_mot(bs, nb_bits_en_plus(s), v[i]) ;
+}
+
+/*
+ * Décodage d'un symbole avec l'état "*x"
+ */
+
+static int decode_rans(const struct table_rans *t, unsigned int *x
+		       , const unsigned char **p, const unsigned char *fin)
+{
+  unsigned int reste = *x & (TOTAL_RANS - 1) ;
+  int s = t->symbole[reste] ;
+
+  *x = t->frequence[s] * (*x >> BITS_RANS) + reste - t->debut[s] ;
+  while( *x < BAS_RANS )
+    {
+      if ( *p == fin )
+	EXCEPTION_LANCE(Exception_fichier_lecture) ;
+      *x = (*x << 8) | *(*p)++ ;
+    }
+  return s ;
+}
+
+/*
+ * Lit les "n" entiers écrits par "put_rans"
+ */
+
+void get_rans(struct bitstream *bs, unsigned int *v, size_t n)
+{
+  struct table_rans *t ;
+  unsigned char *octets ;
+  const unsigned char *p, *fin ;
+  unsigned int x[NB_ETATS] ;
+  size_t i, taille ;
+  int s, k ;
+
+  if ( n == 0 )
+    return ;
+  ALLOUER(t, 1) ;
+  lit_frequences(bs, t) ;
+  taille = get_bits(bs, 32) ;
+  if ( taille < 4*NB_ETATS )
+    EXCEPTION_LANCE(Exception_fichier_lecture) ;
+  ALLOUER(octets, taille) ;
+  get_octets(bs, octets, taille) ;
+  for(p = octets, k = 0; k < NB_ETATS; k++, p += 4)
+    x[k] = p[0] | p[1] << 8 | p[2] << 16 | (unsigned int)p[3] << 24 ;
+  fin = octets + taille ;
+
+  /* Les quatre états à chaque tour, sans dépendance entre eux */
+  for(i = 0; i + NB_ETATS <= n; i += NB_ETATS)
+    for(k = 0; k < NB_ETATS; k++)
+      v[i+k] = decode_rans(t, &x[k], &p, fin) ;
+  for(k = 0; i < n; i++, k++)
+    v[i] = decode_rans(t, &x[k], &p, fin) ;
+
+  for(i = 0; i < n; i++)
+    if ( v[i] >= NB_DIRECT )
+      {
+	s = nb_bits_en_plus(v[i]) ;
+	v[i] = (1u << s) | get_mot(bs, s) ;
+      }
+  free(octets) ;
+  free(t) ;
+}
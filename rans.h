@@ -0,0 +1,14 @@
+/*
+ * Codage rANS par bloc, quatre états entrelacés
+ */
+
+#ifndef _HOME_EXCO_REDACTEX_COURS_TRANS_COMP_IMAGE_TP_DCT2_RANS_H
+#define _HOME_EXCO_REDACTEX_COURS_TRANS_COMP_IMAGE_TP_DCT2_RANS_H
+
+#include "bitstream.h"
+
+void normalise_frequences(const unsigned int *nb_occurrences, int nb_symboles, unsigned int total, unsigned int *frequences) ;
+void put_rans(struct bitstream *bs, const unsigned int *v, size_t n) ;
+void get_rans(struct bitstream *bs, unsigned int *v, size_t n) ;
+
+#endif
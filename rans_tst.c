@@ -0,0 +1,139 @@
+#include "rans.h"
+#include "exception.h"
+#include "bits.h"
+
+void normalise_frequences_tst()
+{
+  static unsigned int occ[] = { 0, 1, 1000000, 3, 0, 500000 } ;
+  unsigned int f[TAILLE(occ)], rares[300], fr[300] ;
+  unsigned int somme ;
+  int i ;
+
+  normalise_frequences(occ, TAILLE(occ), 4096, f) ;
+  for(somme = 0, i = 0; i < TAILLE(occ); i++)
+    {
+      if ( (occ[i] == 0) != (f[i] == 0) )
+	{
+	  eprintf("Le symbole %d a une fréquence %u pour %u occurrences\n"
+		  , i, f[i], occ[i]) ;
+	  return ;
+	}
+      somme += f[i] ;
+    }
+  if ( somme != 4096 || f[2] < 2*f[5] - 2 || f[2] > 2*f[5] + 2 )
+    {
+      eprintf("Mauvaises fréquences : somme %u, %u et %u\n"
+	      , somme, f[2], f[5]) ;
+      return ;
+    }
+
+  /* Beaucoup de symboles rares : ils doivent tous garder 1 */
+  for(i = 0; i < TAILLE(rares); i++)
+    rares[i] = i == 0 ? 100000 : 1 + i % 2 ;
+  normalise_frequences(rares, TAILLE(rares), 256 + 128, fr) ;
+  for(somme = 0, i = 0; i < TAILLE(rares); i++)
+    {
+      if ( fr[i] == 0 )
+	{
+	  eprintf("Un symbole rare a une fréquence nulle\n") ;
+	  return ;
+	}
+      somme += fr[i] ;
+    }
+  if ( somme != 256 + 128 )
+    {
+      eprintf("La somme est %u au lieu de %u\n", somme, 256 + 128) ;
+      return ;
+    }
+}
+
+/*
+ * 20000 entiers dont 90% de 0 : l'entropie est de 0.63 bit par entier
+ * alors qu'un code de Huffman utilise au moins 1 bit.
+ */
+
+void put_rans_tst()
+{
+  static unsigned int v[20000] ;
+  struct bitstream *bs ;
+  int i ;
+
+  for(i=0; i<TAILLE(v); i++)
+    v[i] = rand() % 10 ? 0 : 1 + rand() % 3 ;
+  bs = open_bitstream_memory(NULL, 0) ;
+  put_rans(bs, v, TAILLE(v)) ;
+  if ( bitstream_nb_bits(bs) > 20000 * 0.65 + 200 )
+    {
+      eprintf("%llu bits, c'est trop\n", bitstream_nb_bits(bs)) ;
+      return ;
+    }
+  close_bitstream(bs) ;
+}
+
+void get_rans_tst()
+{
+  static unsigned int v[20000], w[20000+1] ;
+  struct bitstream *bs, *lu ;
+  unsigned char *buf ;
+  size_t taille, n ;
+  int i, j, r ;
+
+  for(j=0; j<4; j++)
+    {
+      for(i=0; i<TAILLE(v); i++)
+	switch(j)
+	  {
+	  case 0: v[i] = rand() % 20 ; break ;
+	  case 1: v[i] = (unsigned int)rand() >> (rand() % 32) ; break ;
+	  case 2: v[i] = i % 300 == 0 ? 0xFFFFFFFF : rand() % 3 ; break ;
+	  case 3: v[i] = 7 ; break ;
+	  }
+      /* Toutes les longueurs pour passer par la fin des états */
+      for(n=0; n<TAILLE(v); n += n < 20 ? 1 : 4999)
+	{
+	  bs = open_bitstream_memory(NULL, 0) ;
+	  put_rans(bs, v, n) ;
+	  put_bits(bs, 7, 0x55) ;
+	  buf = bitstream_memory(bs, &taille) ;
+	  lu = open_bitstream_memory_read(buf, taille) ;
+	  w[n] = 1234 ;
+	  get_rans(lu, w, n) ;
+	  if ( get_bits(lu, 7) != 0x55 )
+	    {
+	      eprintf("Le décodage de %lu entiers ne lit pas tout (cas %d)\n"
+		      , (unsigned long)n, j) ;
+	      return ;
+	    }
+	  close_bitstream(lu) ;
+	  close_bitstream(bs) ;
+	  if ( memcmp(v, w, n*sizeof(*v)) || w[n] != 1234 )
+	    {
+	      eprintf("Mauvais décodage de %lu entiers (cas %d)\n"
+		      , (unsigned long)n, j) ;
+	      return ;
+	    }
+	}
+    }
+
+  /*
+   * Un flot tronqué
+   */
+  for(i=0; i<1000; i++)
+    v[i] = rand() % 1000 ;
+  bs = open_bitstream_memory(NULL, 0) ;
+  put_rans(bs, v, 1000) ;
+  buf = bitstream_memory(bs, &taille) ;
+  lu = open_bitstream_memory_read(buf, taille/2) ;
+  r = 0 ;
+  EXCEPTION(get_rans(lu, w, 1000) ;
+	    ,
+	    ,
+	    case Exception_fichier_lecture:
+	    r = 1 ;
+	    break ;
+	    ) ;
+  close_bitstream(lu) ;
+  close_bitstream(bs) ;
+  if ( r == 0 )
+    eprintf("Pas d'exception sur un flot tronqué\n") ;
+}
@@ -39,26 +39,50 @@
 /*
  * Stocker le tableau de flottant dans les deux "instream"
  * En perdant le moins d'information possible.
+ *
+ * Les nombres de zéros et les valeurs sont d'abord rangés dans deux
+ * tableaux. Si les deux "intstream" sont séparés, chaque tableau
+ * est écrit d'un coup, sinon il faut les intercaler.
+ * Les tableaux de travail sont partagés et agrandis à la demande :
+ * aucune allocation par bloc, quelle que soit la taille des blocs.
  */
 
+static int *travail_zeros = NULL, *travail_valeurs = NULL ;
+static int taille_travail = 0 ;
+
+static void agrandit_travail(int nbe)
+{
+  if ( nbe + 1 <= taille_travail )
+    return ;
+  taille_travail = nbe + 1 ;
+  free(travail_zeros) ;
+  free(travail_valeurs) ;
+  ALLOUER(travail_zeros, taille_travail) ;
+  ALLOUER(travail_valeurs, taille_travail) ;
+}
+
 void compresse(struct intstream *entier, struct intstream *entier_signe
 	       , int nbe, const float *dct)
 {
-
+	int *nb_zeros, *valeurs;
+	int nb_valeurs = 0;
 	int indice_dct;
 	int nb_zero = 0;
 	int valeur_dct;
+
+	agrandit_travail(nbe);
+	nb_zeros = travail_zeros;
+	valeurs = travail_valeurs;
+
 	for(indice_dct = 0; indice_dct < nbe; indice_dct++)
 	{
 		valeur_dct = rint(dct[indice_dct]);
 		//Si l'on trouve un 0 on incrément le nombre de zero et on poursuit
 		if( valeur_dct )
 		{
-
-			//On stocke le nombre de zero que l'on a vu avant
-			put_entier_intstream(entier, nb_zero);
-			//On stocke cette valeur
-			put_entier_intstream(entier_signe, valeur_dct);
+			//Le nombre de zero que l'on a vu avant et cette valeur
+			nb_zeros[nb_valeurs] = nb_zero;
+			valeurs[nb_valeurs++] = valeur_dct;
 			//On remet a 0
 			nb_zero = 0;
 		}
@@ -67,19 +91,71 @@ void compresse(struct intstream *entier, struct intstream *entier_signe
 
 	}
 	//Si on finit par des 0 ne pas oublier d'ajouter le nombre de 0
-	if( nb_zero )
-		put_entier_intstream(entier, nb_zero);
+	nb_zeros[nb_valeurs] = nb_zero;
+
+	if( intstream_separe(entier) && intstream_separe(entier_signe) )
+	{
+		put_entiers_intstream(entier, nb_zeros, nb_valeurs + (nb_zero != 0));
+		put_entiers_intstream(entier_signe, valeurs, nb_valeurs);
+	}
+	else
+	{
+		for(indice_dct = 0; indice_dct < nb_valeurs; indice_dct++)
+		{
+			put_entier_intstream(entier, nb_zeros[indice_dct]);
+			put_entier_intstream(entier_signe, valeurs[indice_dct]);
+		}
+		if( nb_zero )
+			put_entier_intstream(entier, nb_zero);
+	}
 }
 
 /*
  * Lit le tableau de flottant qui est dans les deux "instream"
+ *
+ * Si les "intstream" sont séparés, on lit d'abord tous les nombres
+ * de zéros pour savoir combien il y a de valeurs,
+ * puis toutes les valeurs d'un coup.
  */
 
+static void decompresse_separe(struct intstream *entier
+			       , struct intstream *entier_signe
+			       , int nbe, float *dct)
+{
+	int *positions, *valeurs;
+	int nb_valeurs = 0;
+	int indice_dct = 0;
+	int i;
+
+	agrandit_travail(nbe);
+	positions = travail_zeros;
+	valeurs = travail_valeurs;
+
+	while(indice_dct < nbe)
+	{
+		indice_dct += get_entier_intstream(entier);
+		if(indice_dct < nbe)
+			positions[nb_valeurs++] = indice_dct++;
+	}
+	get_entiers_intstream(entier_signe, valeurs, nb_valeurs);
+
+	for(i = 0; i < nbe; i++)
+		dct[i] = 0;
+	for(i = 0; i < nb_valeurs; i++)
+		dct[positions[i]] = valeurs[i];
+}
+
 void decompresse(struct intstream *entier, struct intstream *entier_signe
 		 , int nbe, float *dct)
 {
 	int nb_zero;
 	int indice_dct;
+
+	if( intstream_separe(entier) && intstream_separe(entier_signe) )
+	{
+		decompresse_separe(entier, entier_signe, nbe, dct);
+		return;
+	}
 	for(indice_dct = 0; indice_dct < nbe; indice_dct++)
 	{
 		//On commence par ajouter des zeros si on en a
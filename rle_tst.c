@@ -62,6 +62,49 @@ void compresse_tst()
   return ;
 }
 
+/*
+ * Avec des "intstream" séparés, les tableaux sont écrits d'un coup
+ */
+void compresse_separe_test(int nb_t, float *t)
+{
+  struct intstream *is[2] ;
+  struct bitstream *bs ;
+  float u[nb_t+1] ;
+  int i ;
+
+  bs = open_bitstream("xxx", "w") ;
+  is[0] = open_intstream_separe("w", Entier, NULL) ;
+  is[1] = open_intstream_separe("w", Entier_Signe, NULL) ;
+  compresse(is[0], is[1], nb_t, t) ;
+  compresse(is[0], is[1], nb_t, t) ;
+  ecrit_trame_intstreams(bs, is, 2) ;
+  close_intstream(is[0]) ;
+  close_intstream(is[1]) ;
+  close_bitstream(bs) ;
+
+  bs = open_bitstream("xxx", "r") ;
+  is[0] = open_intstream_separe("r", Entier, NULL) ;
+  is[1] = open_intstream_separe("r", Entier_Signe, NULL) ;
+  lit_trame_intstreams(bs, is, 2) ;
+  u[nb_t] = 1234 ;
+  decompresse(is[0], is[1], nb_t, u) ;
+  decompresse(is[0], is[1], nb_t, u) ;
+  for(i=0; i<nb_t; i++)
+    if ( rint(t[i]) != rint(u[i]) )
+      {
+	eprintf("Mauvais décodage RLE séparé pour l'entier %d\n", i) ;
+	return ;
+      }
+  if ( u[nb_t] != 1234 )
+    {
+      eprintf("Vous avez débordé du tableau\n") ;
+      return ;
+    }
+  close_intstream(is[0]) ;
+  close_intstream(is[1]) ;
+  close_bitstream(bs) ;
+}
+
 void decompresse_tst()
 {
   static float ok[] = { 0, -1, 0, 0, 1, 2, 0,0,0 } ;
@@ -95,4 +138,11 @@ void decompresse_tst()
 	eprintf("Vous avez débordé du tableau\n", i) ;
 	return ;
       }
+
+  compresse_separe_test(TAILLE(ok), ok) ;
+  t[0] = 0 ; t[1] = 0 ; t[2] = 7 ;
+  compresse_separe_test(3, t) ;
+  t[0] = 7 ; t[1] = 0 ; t[2] = 0 ;
+  compresse_separe_test(3, t) ;
 }
+
@@ -9,6 +9,8 @@
 
 #include "bits.h"
 #include "sf.h"
+#include "exception.h"
+#include <limits.h>
 
 #define VALEUR_ESCAPE 0x7fffffff /* Plus grand entier positif */
 
@@ -16,14 +18,305 @@ struct evenement
 {
   int valeur ;
   int nb_occurrences ;
+  int gele ;			/* Position dans la table gelée ou -1 */
 } ;
 
+/*
+ * Mode semi-statique : tous les "periode" événements, les codes
+ * de la table courante sont calculés une fois pour toutes et gelés.
+ * Jusqu'à la reconstruction suivante, un événement est codé par
+ * son code gelé et décodé en regardant BITS_TABLE_SF bits d'un coup.
+ * Les nombres d'occurrences continuent d'être mis à jour.
+ *
+ * Un événement arrivé depuis la reconstruction n'a pas de code gelé,
+ * il est envoyé avec le code de ESCAPE suivi de sa valeur.
+ *
+ * Les codes plus longs que BITS_TABLE_SF sont finis de décoder
+ * en descendant l'arbre gelé bit à bit.
+ * Une référence dans l'arbre est un numéro de noeud (>= 0)
+ * ou "-(position+1)" pour une feuille.
+ *
+ * Le flot commence par un bit : 0 pour un flot dynamique sans
+ * vieillissement, 1 s'il est suivi de la période (0 : dynamique)
+ * et du seuil de vieillissement (0 : aucun), sur 32 bits chacun.
+ * Le décodeur prend donc le mode et le seuil en lisant le flot.
+ */
+
+#define BITS_TABLE_SF 11
+
+struct code_gele
+{
+  Buffer_Bit code ;
+  int longueur ;
+  int valeur ;
+} ;
+
+struct noeud_gele
+{
+  int fils[2] ;
+} ;
+
+struct entree_table_sf
+{
+  int reference ;		/* Feuille ou noeud où l'on arrive */
+  int longueur ;		/* Nombre de bits consommés */
+} ;
+
+struct semi_statique
+{
+  int periode ;
+  int nb_avant_reconstruction ;
+  int nb_geles ;
+  int taille_geles ;
+  struct code_gele *geles ;
+  struct noeud_gele *noeuds ;
+  int nb_noeuds ;
+  int racine ;
+  struct entree_table_sf table[1 << BITS_TABLE_SF] ;
+} ;
+
+/*
+ * Index donnant la position d'un événement à partir de sa valeur.
+ * Les petites valeurs (les plus fréquentes) sont directement
+ * dans "direct", les autres dans une table de hachage
+ * (adressage ouvert, sondage linéaire) agrandie quand elle
+ * est à moitié pleine.
+ * Une case vide contient la position -1.
+ */
+
+#define MIN_DIRECT (-512)
+#define TAILLE_DIRECT 1024
+
+struct case_hachage
+{
+  int valeur ;
+  int position ;
+} ;
+
+/*
+ * Les nombres d'occurrences sont aussi rangés dans un arbre de Fenwick
+ * (indicé à partir de 1) pour calculer la somme des occurrences
+ * des "n" premiers événements en un temps logarithmique.
+ * "arbre[i]" contient la somme des occurrences des événements
+ * "i - (i & -i)" à "i - 1".
+ */
+
+/*
+ * Les tables sont agrandies (en doublant leur taille) quand elles
+ * sont pleines : un petit alphabet ne coûte que quelques kilo-octets.
+ */
+
+#define TAILLE_INITIALE 64
+
+/*
+ * Vieillissement : quand le total des occurrences dépasse "total_max",
+ * chaque nombre d'occurrences "c" devient "(c+1)/2".
+ * Le modèle suit ainsi un signal qui change et les nombres ne débordent pas.
+ * La division garde l'ordre du tableau et aucun nombre ne devient nul.
+ * "total_max" vaut 0 pour ne jamais vieillir, il est écrit dans le flot.
+ */
+
 struct shannon_fano
 {
   int nb_evenements ;
-  struct evenement evenements[200000] ;
+  int taille_evenements ;	/* Nombre de cases allouées */
+  int pas_arbre ;		/* Plus grande puissance de 2 <= taille */
+  int *arbre ;			/* "taille_evenements + 1" cases */
+  int total ;			/* Somme de toutes les occurrences */
+  int total_max ;		/* Seuil de vieillissement, 0 : aucun */
+  int direct[TAILLE_DIRECT] ;
+  struct case_hachage *hachage ;
+  int taille_hachage ;		/* Puissance de 2 */
+  int nb_hachage ;		/* Nombre de cases utilisées */
+  struct evenement *evenements ;
+  struct semi_statique *semi_statique ; /* NULL en mode dynamique */
+  Booleen entete ;		/* Le mode et le seuil sont écrits/lus */
 } ;
 
+static unsigned int hache(int valeur, int taille)
+{
+  return ((unsigned int)valeur * 2654435761u) & (taille - 1) ;
+}
+
+/*
+ * Ajoute "nb" au nombre d'occurrences de l'événement "position"
+ * dans l'arbre.
+ */
+
+static void ajoute_occurrences(struct shannon_fano *sf, int position, int nb)
+{
+  sf->total += nb ;
+  for(position++ ; position <= sf->taille_evenements ;
+      position += position & -position)
+    sf->arbre[position] += nb ;
+}
+
+/*
+ * Somme des occurrences des événements "0" à "n-1".
+ */
+
+static int somme_occurrences(const struct shannon_fano *sf, int n)
+{
+  int somme = 0 ;
+
+  for( ; n > 0 ; n -= n & -n)
+    somme += sf->arbre[n] ;
+  return somme ;
+}
+
+/*
+ * Retourne le plus grand "n" tel que la somme des occurrences
+ * des "n" premiers événements soit inférieure à "cible".
+ * Cette somme est stockée dans "*somme".
+ */
+
+static int cherche_somme(const struct shannon_fano *sf, int cible, int *somme)
+{
+  int n = 0, pas ;
+
+  *somme = 0 ;
+  for(pas = sf->pas_arbre ; pas ; pas /= 2)
+    if ( n + pas <= sf->taille_evenements
+	 && *somme + sf->arbre[n + pas] < cible )
+      {
+	n += pas ;
+	*somme += sf->arbre[n] ;
+      }
+  return n ;
+}
+
+/*
+ * Retourne l'adresse de la position de "valeur" dans l'index.
+ * Si elle n'y est pas, c'est l'adresse de la case (vide : -1)
+ * où il faut la mettre.
+ */
+
+static int* case_index(struct shannon_fano *sf, int valeur)
+{
+  unsigned int i ;
+
+  if ( valeur >= MIN_DIRECT && valeur < MIN_DIRECT + TAILLE_DIRECT )
+    return &sf->direct[valeur - MIN_DIRECT] ;
+
+  for(i = hache(valeur, sf->taille_hachage) ;
+      sf->hachage[i].position >= 0 && sf->hachage[i].valeur != valeur ;
+      i = (i + 1) & (sf->taille_hachage - 1))
+    ;
+  sf->hachage[i].valeur = valeur ;
+  return &sf->hachage[i].position ;
+}
+
+static void agrandit_hachage(struct shannon_fano *sf)
+{
+  struct case_hachage *ancien = sf->hachage ;
+  int i, taille = sf->taille_hachage ;
+
+  sf->taille_hachage = taille ? 2*taille : 64 ;
+  ALLOUER(sf->hachage, sf->taille_hachage) ;
+  for(i=0; i<sf->taille_hachage; i++)
+    sf->hachage[i].position = -1 ;
+  for(i=0; i<taille; i++)
+    if ( ancien[i].position >= 0 )
+      *case_index(sf, ancien[i].valeur) = ancien[i].position ;
+  free(ancien) ;
+}
+
+/*
+ * Construit l'arbre à partir des nombres d'occurrences du tableau.
+ */
+
+static void construit_arbre(struct shannon_fano *sf)
+{
+  size_t i, j, taille = sf->taille_evenements ;
+
+  sf->total = 0 ;
+  for(i=1; i<=taille; i++)
+    {
+      sf->arbre[i] = i <= (size_t)sf->nb_evenements
+	? sf->evenements[i-1].nb_occurrences : 0 ;
+      sf->total += sf->arbre[i] ;
+    }
+  for(i=1; i<=taille; i++)
+    {
+      j = i + (i & -i) ;
+      if ( j <= taille )
+	sf->arbre[j] += sf->arbre[i] ;
+    }
+}
+
+/*
+ * Double la taille du tableau des événements et reconstruit l'arbre.
+ */
+
+static void agrandit_evenements(struct shannon_fano *sf)
+{
+  size_t taille ;
+
+  if ( sf->taille_evenements > INT_MAX/2 - 1 )
+    {
+      fprintf(stderr, "Trop d'événements dans la table de Shannon-Fano\n") ;
+      EXIT ;
+    }
+  taille = sf->taille_evenements ? 2*sf->taille_evenements : TAILLE_INITIALE ;
+  sf->evenements = realloc(sf->evenements, taille*sizeof(*sf->evenements)) ;
+  if ( sf->evenements == NULL )
+    {
+      fprintf(stderr, "Plus de memoire\n") ;
+      EXIT ;
+    }
+  sf->taille_evenements = taille ;
+  for(sf->pas_arbre = 1 ; 2*sf->pas_arbre <= taille ; sf->pas_arbre *= 2)
+    ;
+
+  free(sf->arbre) ;
+  ALLOUER(sf->arbre, taille + 1) ;
+  construit_arbre(sf) ;
+}
+
+/*
+ * Divise les nombres d'occurrences par deux si le total dépasse le seuil.
+ */
+
+static void vieillit(struct shannon_fano *sf)
+{
+  int i ;
+
+  if ( sf->total_max == 0 || sf->total <= sf->total_max )
+    return ;
+  for(i=0; i<sf->nb_evenements; i++)
+    sf->evenements[i].nb_occurrences
+      = (sf->evenements[i].nb_occurrences + 1) / 2 ;
+  construit_arbre(sf) ;
+}
+
+/*
+ * Ajoute un nouvel événement à la fin du tableau et dans l'index.
+ */
+
+static void ajoute_evenement(struct shannon_fano *sf, int valeur)
+{
+  int *position ;
+
+  if ( sf->nb_evenements == sf->taille_evenements )
+    agrandit_evenements(sf) ;
+
+  if ( 2*(sf->nb_hachage + 1) > sf->taille_hachage )
+    agrandit_hachage(sf) ;
+  position = case_index(sf, valeur) ;
+  if ( *position < 0 )
+    {
+      if ( position < sf->direct || position >= sf->direct + TAILLE_DIRECT )
+	sf->nb_hachage++ ;
+      *position = sf->nb_evenements ;
+    }
+
+  sf->evenements[sf->nb_evenements].valeur = valeur;
+  sf->evenements[sf->nb_evenements].nb_occurrences = 1;
+  sf->evenements[sf->nb_evenements].gele = -1;
+  ajoute_occurrences(sf, sf->nb_evenements, 1);
+  sf->nb_evenements++;
+}
+
 
 
 /*
@@ -33,22 +326,100 @@ struct shannon_fano
 struct shannon_fano* open_shannon_fano()
 {
   struct shannon_fano* sf_retourne;
+  int i;
   ALLOUER(sf_retourne, 1);
 
-  sf_retourne->nb_evenements = 1;
-  sf_retourne->evenements[0].nb_occurrences = 1;
-  sf_retourne->evenements[0].valeur = VALEUR_ESCAPE;
+  for(i = 0; i < TAILLE_DIRECT; i++)
+    sf_retourne->direct[i] = -1;
+  sf_retourne->hachage = NULL;
+  sf_retourne->taille_hachage = 0;
+  sf_retourne->nb_hachage = 0;
+  sf_retourne->nb_evenements = 0;
+  sf_retourne->taille_evenements = 0;
+  sf_retourne->evenements = NULL;
+  sf_retourne->arbre = NULL;
+  sf_retourne->total = 0;
+  sf_retourne->total_max = 0;
+  sf_retourne->semi_statique = NULL;
+  sf_retourne->entete = Faux;
+  ajoute_evenement(sf_retourne, VALEUR_ESCAPE);
 
   return sf_retourne ;
 }
 
 
 
+static struct semi_statique* nouveau_semi_statique(int periode)
+{
+  struct semi_statique *ss;
+
+  ALLOUER(ss, 1);
+  ss->periode = periode;
+  ss->nb_avant_reconstruction = 0;
+  ss->nb_geles = 0;
+  ss->taille_geles = 0;
+  ss->geles = NULL;
+  ss->noeuds = NULL;
+  ss->nb_noeuds = 0;
+  return ss;
+}
+
+static void libere_semi_statique(struct semi_statique *ss)
+{
+  free(ss->geles);
+  free(ss->noeuds);
+  free(ss);
+}
+
+/*
+ * Comme "open_shannon_fano" mais les codes sont gelés et reconstruits
+ * tous les "periode" événements.
+ * Le mode et la période sont écrits au début du flot. Le décodeur
+ * utilise ceux qu'il lit : il peut être ouvert par l'une ou l'autre
+ * fonction, avec n'importe quelle période.
+ */
+struct shannon_fano* open_shannon_fano_semi_statique(int periode)
+{
+  struct shannon_fano* sf = open_shannon_fano();
+
+  if(periode <= 0)
+  {
+    fprintf(stderr, "La période de reconstruction doit être positive\n");
+    EXIT;
+  }
+  sf->semi_statique = nouveau_semi_statique(periode);
+
+  return sf;
+}
+
+
+
+/*
+ * Active le vieillissement des occurrences (0 le désactive).
+ * Le seuil est transmis : il est inutile de l'appeler avant le décodage.
+ */
+void vieillissement_shannon_fano(struct shannon_fano *sf, int total_max)
+{
+  if(total_max < 0 || total_max > INT_MAX/2)
+  {
+    fprintf(stderr, "Seuil de vieillissement incorrect : %d\n", total_max);
+    EXIT;
+  }
+  sf->total_max = total_max;
+}
+
+
+
 /*
  * Fermeture (libération mémoire)
  */
 void close_shannon_fano(struct shannon_fano *sf)
 {
+  free(sf->hachage);
+  free(sf->evenements);
+  free(sf->arbre);
+  if(sf->semi_statique)
+    libere_semi_statique(sf->semi_statique);
   free(sf);
 }
 
@@ -59,17 +430,18 @@ void close_shannon_fano(struct shannon_fano *sf)
  * En sortie la position de l'événement dans le tableau "evenements"
  * Si l'événement n'est pas trouvé, on retourne la position
  * de l'événement ESCAPE.
+ *
+ * La position est donnée par l'index, qui est mis à jour
+ * à chaque déplacement d'un événement dans le tableau.
  */
-static int trouve_position(const struct shannon_fano *sf, int evenement)
+static int trouve_position(struct shannon_fano *sf, int evenement)
 {
-  int indice_evenement;
-  for(indice_evenement = 0; indice_evenement < sf->nb_evenements; indice_evenement++)
-  {
-    if(sf->evenements[indice_evenement].valeur == evenement)
-      return indice_evenement;
-  }
+  int position = *case_index(sf, evenement);
+
+  if(position >= 0)
+    return position;
   //Sinon on return la position de l'evenement ESCAPE
-  return trouve_position(sf, VALEUR_ESCAPE);
+  return *case_index(sf, VALEUR_ESCAPE);
 }
 
 
@@ -88,34 +460,26 @@ static int trouve_position(const struct shannon_fano *sf, int evenement)
  * de la somme des occurrences supérieures et inférieures.
  *
  * L'algorithme (trivial) n'est pas facile à trouver, réfléchissez bien.
+ *
+ * Les sommes sont prises dans l'arbre : on ne parcourt pas le sous-tableau.
  */
 static int trouve_separation(const struct shannon_fano *sf
 			     , int position_min
 			     , int position_max)
 {
-  int somme_totale = 0;
-  int somme_sup = 0;
-  int somme_inf ;
-  int i;
-
-  //On calcule la somme des valeurs evenements
-  for(i = position_min; i<= position_max; i++)
-  {
-    somme_totale += sf->evenements[i].nb_occurrences;
-  }
-  somme_inf = somme_totale;
+  int somme_avant = somme_occurrences(sf, position_min);
+  int somme_totale = somme_occurrences(sf, position_max+1) - somme_avant;
+  int somme_sup, somme_inf, somme;
+
+  /*
+   * On cherche la première position telle que la somme des occurrences
+   * qui la suivent soit inférieure ou égale à la moitié du total.
+   */
+  position_min = cherche_somme(sf, somme_avant + somme_totale
+			       - somme_totale/2, &somme);
+  somme_sup = somme_totale - (somme - somme_avant);
+  somme_inf = somme_sup - sf->evenements[position_min].nb_occurrences;
 
-  while(position_min <= position_max)
-  {
-    somme_inf -= sf->evenements[position_min].nb_occurrences;
-    if(somme_inf <= (somme_totale/2))
-    {
-      somme_sup = somme_inf + sf->evenements[position_min].nb_occurrences;
-      break;
-    }
-    position_min++;
-  }
-  
   //On calcul la difference de chaque coté de la frontiere puis on prend la diff la plus petite
   if(somme_sup - (somme_totale/2) < (somme_totale/2) - somme_inf)
     return position_min-1;
@@ -159,40 +523,212 @@ static void encode_position(struct bitstream *bs,struct shannon_fano *sf,
  * Cette fonction incrémente le nombre d'occurrence de
  * "sf->evenements[position]"
  * Puis elle modifie le tableau pour qu'il reste trié par nombre
- * d'occurrence (un simple échange d'événement suffit)
+ * d'occurrence.
  *
  * Les faibles indices correspondent aux grand nombres d'occurrences
+ *
+ * L'événement échange sa place avec le premier de ceux qui avaient
+ * le même nombre d'occurrences que lui : le tableau reste trié
+ * et seules deux cases bougent.
+ * Le premier du bloc est trouvé par dichotomie car le tableau est trié.
  */
 
 static void incremente_et_ordonne(struct shannon_fano *sf, int position)
 {
   struct evenement evenement_temp;
-  sf->evenements[position].nb_occurrences++;
+  int nb = sf->evenements[position].nb_occurrences;
+  int premier = 0, fin = position, milieu;
 
-  //Revoir le for car cas inutiles
-  /*for(position = position; position > 0; position--)
+  while(premier < fin)
   {
-    if(sf->evenements[position-1].nb_occurrences < sf->evenements[position].nb_occurrences)
-    {
-      evenement_temp = sf->evenements[position-1];
-      sf->evenements[position-1] = sf->evenements[position];
-      sf->evenements[position] = evenement_temp;
-    }		
-  } */
-
-  while( (sf->evenements[position-1].nb_occurrences < 
-          sf->evenements[position].nb_occurrences) &&
-          position > 0) 
+    milieu = (premier + fin) / 2;
+    if(sf->evenements[milieu].nb_occurrences > nb)
+      premier = milieu + 1;
+    else
+      fin = milieu;
+  }
+
+  /* Seul le nombre d'occurrences à la position "premier" change */
+  ajoute_occurrences(sf, premier, 1);
+  if(premier != position)
   {
-    evenement_temp = sf->evenements[position-1];
-    sf->evenements[position-1] = sf->evenements[position];
+    evenement_temp = sf->evenements[premier];
+    sf->evenements[premier] = sf->evenements[position];
     sf->evenements[position] = evenement_temp;
-    position--;
-  }  
+    *case_index(sf, sf->evenements[position].valeur) = position;
+    *case_index(sf, sf->evenements[premier].valeur) = premier;
+  }
+  sf->evenements[premier].nb_occurrences++;
+  vieillit(sf);
 }
 
 
 
+/*
+ * Calcule le code gelé des événements "position_min..position_max"
+ * dont le préfixe commun est "code" (sur "longueur" bits).
+ * Retourne la référence du sous-arbre créé.
+ */
+static int gele_codes(struct shannon_fano *sf, int position_min
+		      , int position_max, Buffer_Bit code, int longueur)
+{
+  struct semi_statique *ss = sf->semi_statique;
+  int separation, noeud;
+
+  if(position_min == position_max)
+  {
+    if(longueur > 8*(int)sizeof(Buffer_Bit))
+    {
+      fprintf(stderr, "Code de Shannon-Fano trop long : %d bits\n", longueur);
+      EXIT;
+    }
+    ss->geles[position_min].code = code;
+    ss->geles[position_min].longueur = longueur;
+    ss->geles[position_min].valeur = sf->evenements[position_min].valeur;
+    sf->evenements[position_min].gele = position_min;
+    return -(position_min + 1);
+  }
+  separation = trouve_separation(sf, position_min, position_max);
+  noeud = ss->nb_noeuds++;
+  ss->noeuds[noeud].fils[0] = gele_codes(sf, position_min, separation
+					 , code << 1, longueur + 1);
+  ss->noeuds[noeud].fils[1] = gele_codes(sf, separation + 1, position_max
+					 , (code << 1) | 1, longueur + 1);
+  return noeud;
+}
+
+/*
+ * Remplit les cases de la table de décodage dont les premiers bits
+ * sont "code" (sur "longueur" bits) pour le sous-arbre "reference".
+ */
+static void remplit_table_sf(struct semi_statique *ss, int reference
+			     , unsigned int code, int longueur)
+{
+  int i, debut, nb;
+
+  if(reference >= 0 && longueur < BITS_TABLE_SF)
+  {
+    remplit_table_sf(ss, ss->noeuds[reference].fils[0], code << 1
+		     , longueur + 1);
+    remplit_table_sf(ss, ss->noeuds[reference].fils[1], (code << 1) | 1
+		     , longueur + 1);
+    return;
+  }
+  debut = code << (BITS_TABLE_SF - longueur);
+  nb = 1 << (BITS_TABLE_SF - longueur);
+  for(i = debut; i < debut + nb; i++)
+  {
+    ss->table[i].reference = reference;
+    ss->table[i].longueur = longueur;
+  }
+}
+
+/*
+ * Gèle les codes de la table courante et construit la table de décodage.
+ */
+static void reconstruit(struct shannon_fano *sf)
+{
+  struct semi_statique *ss = sf->semi_statique;
+
+  if(sf->nb_evenements > ss->taille_geles)
+  {
+    free(ss->geles);
+    free(ss->noeuds);
+    ss->taille_geles = sf->taille_evenements;
+    ALLOUER(ss->geles, ss->taille_geles);
+    ALLOUER(ss->noeuds, ss->taille_geles);
+  }
+  ss->nb_geles = sf->nb_evenements;
+  ss->nb_noeuds = 0;
+  ss->racine = gele_codes(sf, 0, sf->nb_evenements - 1, 0, 0);
+  remplit_table_sf(ss, ss->racine, 0, 0);
+  ss->nb_avant_reconstruction = ss->periode;
+}
+
+/*
+ * Mise à jour du modèle après le codage de "valeur" en mode semi-statique.
+ * Comme en dynamique, une valeur inconnue est ajoutée
+ * et c'est ESCAPE qui est compté.
+ */
+static void compte_semi_statique(struct shannon_fano *sf, int valeur)
+{
+  int position = *case_index(sf, valeur);
+
+  if(position < 0)
+  {
+    ajoute_evenement(sf, valeur);
+    position = *case_index(sf, VALEUR_ESCAPE);
+  }
+  incremente_et_ordonne(sf, position);
+  sf->semi_statique->nb_avant_reconstruction--;
+}
+
+static void put_entier_semi_statique(struct bitstream *bs
+				     , struct shannon_fano *sf, int evenement)
+{
+  struct semi_statique *ss = sf->semi_statique;
+  int position;
+  struct code_gele *c;
+
+  if(ss->nb_avant_reconstruction == 0)
+    reconstruit(sf);
+
+  position = *case_index(sf, evenement);
+  if(position < 0 || sf->evenements[position].gele < 0)
+    position = *case_index(sf, VALEUR_ESCAPE);
+  c = &ss->geles[sf->evenements[position].gele];
+  //Un code de plus de 64 bits est refusé par "gele_codes"
+  if(c->longueur > NB_BITS_MOT)
+  {
+    put_mot(bs, c->longueur - NB_BITS_MOT, c->code >> NB_BITS_MOT);
+    put_mot(bs, NB_BITS_MOT, c->code);
+  }
+  else
+    put_mot(bs, c->longueur, c->code);
+
+  if(c->valeur == VALEUR_ESCAPE)
+    put_bits(bs, sizeof(evenement)*8, evenement);
+  compte_semi_statique(sf, evenement);
+}
+
+static int get_entier_semi_statique(struct bitstream *bs
+				    , struct shannon_fano *sf)
+{
+  struct semi_statique *ss = sf->semi_statique;
+  struct entree_table_sf *e;
+  int reference, valeur;
+
+  if(ss->nb_avant_reconstruction == 0)
+    reconstruit(sf);
+
+  e = &ss->table[peek_bits(bs, BITS_TABLE_SF)];
+  skip_bits(bs, e->longueur);
+  for(reference = e->reference; reference >= 0; )
+    reference = ss->noeuds[reference].fils[get_bit(bs)];
+
+  valeur = ss->geles[-reference - 1].valeur;
+  if(valeur == VALEUR_ESCAPE)
+    valeur = get_bits(bs, sizeof(valeur)*8);
+  compte_semi_statique(sf, valeur);
+
+  return valeur;
+}
+
+
+
+/*
+ * Au premier événement écrit, le mode et le seuil en tête du flot.
+ */
+static void ecrit_mode(struct bitstream *bs, struct shannon_fano *sf)
+{
+  sf->entete = Vrai;
+  put_bit(bs, sf->semi_statique != NULL || sf->total_max != 0);
+  if(sf->semi_statique == NULL && sf->total_max == 0)
+    return;
+  put_bits(bs, 32, sf->semi_statique ? sf->semi_statique->periode : 0);
+  put_bits(bs, 32, sf->total_max);
+}
+
 /*
  * Cette fonction trouve la position de l'événement puis l'encode.
  * Si la position envoyée est celle de ESCAPE, elle fait un "put_bits"
@@ -202,16 +738,22 @@ static void incremente_et_ordonne(struct shannon_fano *sf, int position)
 void put_entier_shannon_fano(struct bitstream *bs
 			     ,struct shannon_fano *sf, int evenement)
 {
-  int position_evenement = trouve_position(sf ,evenement);
+  int position_evenement;
+
+  if(!sf->entete)
+    ecrit_mode(bs, sf);
+  if(sf->semi_statique)
+  {
+    put_entier_semi_statique(bs, sf, evenement);
+    return;
+  }
+  position_evenement = trouve_position(sf ,evenement);
   encode_position(bs, sf, position_evenement);
 
   if(sf->evenements[position_evenement].valeur == VALEUR_ESCAPE)
   {
     put_bits(bs, sizeof(evenement)*8, evenement);
-
-    sf->evenements[sf->nb_evenements].valeur = evenement;
-    sf->evenements[sf->nb_evenements].nb_occurrences = 1;
-    sf->nb_evenements++;
+    ajoute_evenement(sf, evenement);
   }
   
   incremente_et_ordonne(sf, position_evenement);
@@ -245,6 +787,39 @@ static int decode_position(struct bitstream *bs,struct shannon_fano *sf)
 
 
 
+/*
+ * Au premier événement lu, le mode et le seuil sont pris dans le flot :
+ * le modèle devient semi-statique (avec la période lue) ou dynamique
+ * quelle que soit la fonction qui l'a ouvert.
+ */
+static void lit_mode(struct bitstream *bs, struct shannon_fano *sf)
+{
+  int periode = 0;
+
+  sf->entete = Vrai;
+  sf->total_max = 0;
+  if(get_bit(bs))
+  {
+    periode = get_bits(bs, 32);
+    sf->total_max = get_bits(bs, 32);
+    if(periode < 0 || sf->total_max < 0 || sf->total_max > INT_MAX/2)
+      EXCEPTION_LANCE(Exception_fichier_lecture);
+  }
+  if(periode == 0)
+  {
+    if(sf->semi_statique)
+      libere_semi_statique(sf->semi_statique);
+    sf->semi_statique = NULL;
+    return;
+  }
+  if(sf->semi_statique)
+    sf->semi_statique->periode = periode;
+  else
+    sf->semi_statique = nouveau_semi_statique(periode);
+}
+
+
+
 /*
  * Fonction inverse de "put_entier_shannon_fano"
  *
@@ -266,16 +841,19 @@ int get_entier_shannon_fano(struct bitstream *bs, struct shannon_fano *sf)
 
   //retourne x
 
-  int position_element_decode = decode_position(bs, sf);
+  int position_element_decode;
   int valeur_recuperee;
 
+  if(!sf->entete)
+    lit_mode(bs, sf);
+  if(sf->semi_statique)
+    return get_entier_semi_statique(bs, sf);
+  position_element_decode = decode_position(bs, sf);
+
   if(sf->evenements[position_element_decode].valeur == VALEUR_ESCAPE)
   {
     valeur_recuperee = get_bits(bs, sizeof(valeur_recuperee)*8);
-
-    sf->evenements[sf->nb_evenements].valeur = valeur_recuperee;
-    sf->evenements[sf->nb_evenements].nb_occurrences = 1;
-    sf->nb_evenements++;
+    ajoute_evenement(sf, valeur_recuperee);
   }
   else
     valeur_recuperee = sf->evenements[position_element_decode].valeur;
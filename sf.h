@@ -10,6 +10,8 @@
 struct shannon_fano ;
 
 struct shannon_fano* open_shannon_fano() ;
+struct shannon_fano* open_shannon_fano_semi_statique(int periode) ;
+void vieillissement_shannon_fano(struct shannon_fano *sf, int total_max) ;
 
 void close_shannon_fano(struct shannon_fano *sf) ;
 void put_entier_shannon_fano(struct bitstream *bs, struct shannon_fano *sf, int evenement) ;
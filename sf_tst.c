@@ -35,6 +35,151 @@ void open_shannon_fano_tst()
     }
 }
 
+/*
+ * Le décodeur prend le mode et la période dans le flot,
+ * pas dans la fonction qui l'ouvre ni dans son paramètre.
+ */
+
+void open_shannon_fano_semi_statique_tst()
+{
+  struct shannon_fano *sf ;
+  struct bitstream *bs ;
+  int i, j, k ;
+  int periodes[] = { 1, 7, 1000, 0 } ;
+  static int debut[] = { 2147483647, 5, 7, 5 } ;
+
+  for(k=0; k < TAILLE(periodes); k++)
+    {
+      sf = periodes[k] ? open_shannon_fano_semi_statique(periodes[k])
+	: open_shannon_fano() ;
+      bs = open_bitstream("xxx", "w") ;
+      for(i = 0; i < 5000; i++)
+	put_entier_shannon_fano(bs, sf, (i*i) % 97 - 40 + (i%500 == 0)*i*1000) ;
+      close_bitstream(bs) ;
+      close_shannon_fano(sf) ;
+
+      sf = k % 2 ? open_shannon_fano() : open_shannon_fano_semi_statique(3) ;
+      bs = open_bitstream("xxx", "r") ;
+      for(i = 0; i < 5000; i++)
+	{
+	  j = get_entier_shannon_fano(bs, sf) ;
+	  if ( j != (i*i) % 97 - 40 + (i%500 == 0)*i*1000 )
+	    {
+	      eprintf("Période %d, événement %d : j'attend %d et je reçois %d\n"
+		      , periodes[k], i, (i*i) % 97 - 40 + (i%500 == 0)*i*1000
+		      , j) ;
+	      return ;
+	    }
+	  if ( !sf_table_ok(sf) )
+	    return ;
+	}
+      close_bitstream(bs) ;
+      close_shannon_fano(sf) ;
+    }
+
+  /* Le mode ne dépend pas de la première valeur, même 0x7fffffff */
+  for(k=0; k < 2; k++)
+    {
+      sf = k ? open_shannon_fano_semi_statique(2) : open_shannon_fano() ;
+      bs = open_bitstream("xxx", "w") ;
+      for(i = 0; i < 100; i++)
+	put_entier_shannon_fano(bs, sf, debut[i % TAILLE(debut)]) ;
+      close_bitstream(bs) ;
+      close_shannon_fano(sf) ;
+
+      sf = k ? open_shannon_fano() : open_shannon_fano_semi_statique(2) ;
+      bs = open_bitstream("xxx", "r") ;
+      for(i = 0; i < 100; i++)
+	{
+	  j = get_entier_shannon_fano(bs, sf) ;
+	  if ( j != debut[i % TAILLE(debut)] )
+	    {
+	      eprintf("Mode %d, événement %d : j'attend %d et je reçois %d\n"
+		      , k, i, debut[i % TAILLE(debut)], j) ;
+	      return ;
+	    }
+	}
+      close_bitstream(bs) ;
+      close_shannon_fano(sf) ;
+    }
+}
+
+/*
+ * Un signal qui change : 3000 fois 7 puis surtout -2 avec quelques
+ * valeurs rares. Avec le vieillissement le total reste sous le seuil
+ * (il ne peut pas descendre sous le nombre d'événements), -2 finit
+ * premier de la table et le décodage est identique.
+ */
+
+static int total_occurrences(struct shannon_fano *sf)
+{
+  int i, valeur, nb_occ, total ;
+
+  for(total = 0, i = 0; i < sf_get_nb_evenements(sf); i++)
+    {
+      sf_get_evenement(sf, i, &valeur, &nb_occ) ;
+      if ( nb_occ <= 0 )
+	return -1 ;
+      total += nb_occ ;
+    }
+  return total ;
+}
+
+void vieillissement_shannon_fano_tst()
+{
+  struct shannon_fano *sf ;
+  struct bitstream *bs ;
+  int i, j, valeur, nb_occ, modes ;
+
+  for(modes = 0; modes < 2; modes++)
+    {
+      sf = modes ? open_shannon_fano_semi_statique(50) : open_shannon_fano() ;
+      vieillissement_shannon_fano(sf, 200) ;
+      bs = open_bitstream("xxx", "w") ;
+      for(i = 0; i < 6000; i++)
+	{
+	  put_entier_shannon_fano(bs, sf, i < 3000 ? 7 : i % 5 ? -2 : 1000 + i % 40) ;
+	  j = total_occurrences(sf) ;
+	  if ( j < 0 || j > 202 )
+	    {
+	      eprintf("Total des occurrences : %d\n", j) ;
+	      return ;
+	    }
+	}
+      sf_get_evenement(sf, 0, &valeur, &nb_occ) ;
+      if ( valeur != -2 )
+	{
+	  eprintf("Le premier événement est %d au lieu de -2\n", valeur) ;
+	  return ;
+	}
+      close_bitstream(bs) ;
+      close_shannon_fano(sf) ;
+
+      /* Le mode, la période et le seuil sont lus dans le flot */
+      sf = open_shannon_fano() ;
+      bs = open_bitstream("xxx", "r") ;
+      for(i = 0; i < 6000; i++)
+	{
+	  j = get_entier_shannon_fano(bs, sf) ;
+	  if ( j != (i < 3000 ? 7 : i % 5 ? -2 : 1000 + i % 40) )
+	    {
+	      eprintf("Evénement %d : j'attend %d et je reçois %d\n"
+		      , i, i < 3000 ? 7 : i % 5 ? -2 : 1000 + i % 40, j) ;
+	      return ;
+	    }
+	  if ( !sf_table_ok(sf) )
+	    return ;
+	  if ( total_occurrences(sf) > 202 )
+	    {
+	      eprintf("Le décodeur n'a pas lu le seuil de vieillissement\n") ;
+	      return ;
+	    }
+	}
+      close_bitstream(bs) ;
+      close_shannon_fano(sf) ;
+    }
+}
+
 void close_shannon_fano_tst()
 {
 /*
@@ -97,17 +242,26 @@ void put_entier_shannon_fano_tst()
     }
 
   j = 0 ;
+  k = 1 ;
   EXCEPTION
     (
+     k = get_bit(bs) ;
      j = get_bits(bs, sizeof(i)*8) ;
+     get_bits(bs, 7) ;
      ,
      ,
      case Exception_fichier_lecture:
       eprintf("Quand on écrit le premier évenement\n"
-	      "le fichier doit au moins contenir la valeur de l'évenement\n"
+	      "le fichier doit au moins contenir le bit de mode\n"
+	      "et la valeur de l'évenement\n"
 	     ) ;
       return ;
      ) ;
+  if ( k )
+    {
+      eprintf("Le flot dynamique doit commencer par un bit à 0\n") ;
+      return ;
+    }
   
   err = 1 ;
   EXCEPTION
@@ -122,7 +276,7 @@ void put_entier_shannon_fano_tst()
 
   if ( err )
     {
-      eprintf("Le fichier est trop grand (>4 octets)\n") ;
+      eprintf("Le fichier est trop grand (>5 octets)\n") ;
       return ;
     }
   if ( j != i )
@@ -186,8 +340,9 @@ void put_entier_shannon_fano_tst()
 
   EXCEPTION
     (
+     get_bit(bs) ;
      j = get_bits(bs, sizeof(i)*8) ;
-     get_bits(bs, 8) ;
+     get_bits(bs, 7) ;
      ,
      ,
      case Exception_fichier_lecture:
@@ -242,15 +397,21 @@ static int aleatoire2(int n)
 }
 
 
+static int disperse(int n)
+{  
+  return( n % 3 ? n*65537 : n/10 ) ;
+}
+
 void get_entier_shannon_fano_tst()
 {
   struct shannon_fano *sf ;
   struct bitstream *bs ;
   int i, j, k ;
-  int (*t[])(int) = { simple, aleatoire, aleatoire2 } ;
+  int (*t[])(int) = { simple, aleatoire, aleatoire2, disperse } ;
   char *tt[] =  { "les nombres successif entre -1000 et 1000",
-		  "2000 nombres aléatoires entre 0 et 49 inclus"
-		  "2000 nombres aléatoires entre 0 et 49 inclus en gaussienne"
+		  "2000 nombres aléatoires entre 0 et 49 inclus",
+		  "2000 nombres aléatoires entre 0 et 49 inclus en gaussienne",
+		  "des grands nombres (positifs et négatifs) et des petits"
   } ;
   for(k=0; k < TAILLE(t); k++)
     {
@@ -284,4 +445,30 @@ void get_entier_shannon_fano_tst()
       close_bitstream(bs) ;
       close_shannon_fano(sf) ;
     }
+
+  /* Plus d'événements différents que l'ancienne table fixe (200000) */
+  sf = open_shannon_fano() ;
+  bs = open_bitstream("xxx", "w") ;
+  for(i = 0; i < 250000; i++)
+    put_entier_shannon_fano(bs, sf, 7*i - 900000) ;
+  close_bitstream(bs) ;
+  close_shannon_fano(sf) ;
+
+  sf = open_shannon_fano() ;
+  bs = open_bitstream("xxx", "r") ;
+  for(i = 0; i < 250000; i++)
+    {
+      j = get_entier_shannon_fano(bs, sf) ;
+      if ( j != 7*i - 900000 )
+	{
+	  eprintf("Compresse/Décompresse 250000 événements différents\n") ;
+	  eprintf("J'attend %d et je reçois %d\n", 7*i - 900000, j) ;
+	  return ;
+	}
+    }
+  if ( sf_get_nb_evenements(sf) != 250001 )
+    eprintf("La table n'a pas grandi : %d événements\n"
+	    , sf_get_nb_evenements(sf)) ;
+  close_bitstream(bs) ;
+  close_shannon_fano(sf) ;
 }
@@ -3,10 +3,24 @@ void nb_bits_utile_tst() ;
 void pow2_tst() ;
 void prend_bit_tst() ;
 void pose_bit_tst() ;
+void nb_zeros_a_droite_tst() ;
 void open_bitstream_tst() ;
+void open_bitstream_async_tst() ;
+void open_bitstream_memory_tst() ;
+void open_bitstream_memory_read_tst() ;
+void open_bitstream_comptage_tst() ;
+void bitstream_nb_bits_tst() ;
+void bitstream_memory_tst() ;
 void close_bitstream_tst() ;
 void put_bit_tst() ;
 void get_bit_tst() ;
+void put_mot_tst() ;
+void get_mot_tst() ;
+void peek_bits_tst() ;
+void skip_bits_tst() ;
+void put_octets_tst() ;
+void get_octets_tst() ;
+void aligne_bitstream_tst() ;
 void put_bits_tst() ;
 void get_bits_tst() ;
 void put_bit_string_tst() ;
@@ -15,9 +29,35 @@ void get_entier_tst() ;
 void put_entier_signe_tst() ;
 void get_entier_signe_tst() ;
 void open_shannon_fano_tst() ;
+void open_shannon_fano_semi_statique_tst() ;
+void vieillissement_shannon_fano_tst() ;
 void close_shannon_fano_tst() ;
 void put_entier_shannon_fano_tst() ;
 void get_entier_shannon_fano_tst() ;
+void open_golomb_tst() ;
+void close_golomb_tst() ;
+void put_entier_golomb_tst() ;
+void get_entier_golomb_tst() ;
+void put_entier_signe_golomb_tst() ;
+void get_entier_signe_golomb_tst() ;
+void taille_max_vbyte_tst() ;
+void code_vbyte_tst() ;
+void decode_vbyte_tst() ;
+void longueurs_huffman_tst() ;
+void put_huffman_tst() ;
+void get_huffman_tst() ;
+void open_intervalle_tst() ;
+void vieillissement_intervalle_tst() ;
+void close_intervalle_tst() ;
+void code_intervalle_tst() ;
+void decode_intervalle_tst() ;
+void normalise_frequences_tst() ;
+void put_rans_tst() ;
+void get_rans_tst() ;
+void open_vitter_tst() ;
+void close_vitter_tst() ;
+void put_entier_vitter_tst() ;
+void get_entier_vitter_tst() ;
 void allocation_matrice_carree_float_tst() ;
 void liberation_matrice_carree_float_tst() ;
 void coef_dct_tst() ;
@@ -3,10 +3,24 @@
 { "pow2", pow2_tst },
 { "prend_bit", prend_bit_tst },
 { "pose_bit", pose_bit_tst },
+{ "nb_zeros_a_droite", nb_zeros_a_droite_tst },
 { "open_bitstream", open_bitstream_tst },
+{ "open_bitstream_async", open_bitstream_async_tst },
+{ "open_bitstream_memory", open_bitstream_memory_tst },
+{ "open_bitstream_memory_read", open_bitstream_memory_read_tst },
+{ "open_bitstream_comptage", open_bitstream_comptage_tst },
+{ "bitstream_nb_bits", bitstream_nb_bits_tst },
+{ "bitstream_memory", bitstream_memory_tst },
 { "close_bitstream", close_bitstream_tst },
 { "put_bit", put_bit_tst },
 { "get_bit", get_bit_tst },
+{ "put_mot", put_mot_tst },
+{ "get_mot", get_mot_tst },
+{ "peek_bits", peek_bits_tst },
+{ "skip_bits", skip_bits_tst },
+{ "put_octets", put_octets_tst },
+{ "get_octets", get_octets_tst },
+{ "aligne_bitstream", aligne_bitstream_tst },
 { "put_bits", put_bits_tst },
 { "get_bits", get_bits_tst },
 { "put_bit_string", put_bit_string_tst },
@@ -15,9 +29,35 @@
 { "put_entier_signe", put_entier_signe_tst },
 { "get_entier_signe", get_entier_signe_tst },
 { "open_shannon_fano", open_shannon_fano_tst },
+{ "open_shannon_fano_semi_statique", open_shannon_fano_semi_statique_tst },
+{ "vieillissement_shannon_fano", vieillissement_shannon_fano_tst },
 { "close_shannon_fano", close_shannon_fano_tst },
 { "put_entier_shannon_fano", put_entier_shannon_fano_tst },
 { "get_entier_shannon_fano", get_entier_shannon_fano_tst },
+{ "open_golomb", open_golomb_tst },
+{ "close_golomb", close_golomb_tst },
+{ "put_entier_golomb", put_entier_golomb_tst },
+{ "get_entier_golomb", get_entier_golomb_tst },
+{ "put_entier_signe_golomb", put_entier_signe_golomb_tst },
+{ "get_entier_signe_golomb", get_entier_signe_golomb_tst },
+{ "taille_max_vbyte", taille_max_vbyte_tst },
+{ "code_vbyte", code_vbyte_tst },
+{ "decode_vbyte", decode_vbyte_tst },
+{ "longueurs_huffman", longueurs_huffman_tst },
+{ "put_huffman", put_huffman_tst },
+{ "get_huffman", get_huffman_tst },
+{ "open_intervalle", open_intervalle_tst },
+{ "vieillissement_intervalle", vieillissement_intervalle_tst },
+{ "close_intervalle", close_intervalle_tst },
+{ "code_intervalle", code_intervalle_tst },
+{ "decode_intervalle", decode_intervalle_tst },
+{ "normalise_frequences", normalise_frequences_tst },
+{ "put_rans", put_rans_tst },
+{ "get_rans", get_rans_tst },
+{ "open_vitter", open_vitter_tst },
+{ "close_vitter", close_vitter_tst },
+{ "put_entier_vitter", put_entier_vitter_tst },
+{ "get_entier_vitter", get_entier_vitter_tst },
 { "allocation_matrice_carree_float", allocation_matrice_carree_float_tst },
 { "liberation_matrice_carree_float", liberation_matrice_carree_float_tst },
 { "coef_dct", coef_dct_tst },
@@ -0,0 +1,225 @@
+#include "vbyte.h"
+#include "exception.h"
+
+/*
+ * Codage des entiers par octets, rapide plutôt que compact.
+ *
+ * Chaque entier (32 bits) est écrit sur 1 à 4 octets, poids faible
+ * en premier. Le nombre d'octets moins un est codé sur 2 bits,
+ * un octet de contrôle décrit donc 4 entiers.
+ * Tous les octets de contrôle sont au début, suivis de tous
+ * les octets de données :
+ *
+ *     [contrôle 0..3][contrôle 4..7]...[données 0][données 1]...
+ *
+ * Pour le décodage, l'octet de contrôle indexe une table qui donne
+ * le masque de "pshufb" (SSSE3) : une seule instruction place
+ * les octets des 4 entiers à leur place dans un registre de 128 bits.
+ * Avec AVX2 on traite 8 entiers (2 octets de contrôle) à la fois.
+ * Le choix de la version est fait au premier appel comme dans "bit.c".
+ */
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define VBYTE_X86_64 1
+#include <immintrin.h>
+#endif
+
+/*
+ * Nombre d'octets de contrôle pour "n" entiers
+ */
+#define NB_CONTROLES(n) (((n) + 3) / 4)
+
+/*
+ * Taille maximum du codage de "n" entiers
+ */
+
+size_t taille_max_vbyte(size_t n)
+{
+  return NB_CONTROLES(n) + 4*n ;
+}
+
+/*
+ * Retourne le nombre d'octets écrits dans "octets"
+ * (qui doit pouvoir en contenir "taille_max_vbyte(n)").
+ */
+
+size_t code_vbyte(const unsigned int *v, size_t n, unsigned char *octets)
+{
+  unsigned char *controle = octets ;
+  unsigned char *donnees = octets + NB_CONTROLES(n) ;
+  size_t i ;
+  int nb ;
+
+  for(i=0; i<n; i++)
+    {
+      if ( i % 4 == 0 )
+	controle[i/4] = 0 ;
+      nb = v[i] < (1u << 8) ? 1 : v[i] < (1u << 16) ? 2 : v[i] < (1u << 24) ? 3 : 4 ;
+      controle[i/4] |= (nb - 1) << (2 * (i % 4)) ;
+      *donnees++ = v[i] ;
+      if ( nb > 1 ) *donnees++ = v[i] >> 8 ;
+      if ( nb > 2 ) *donnees++ = v[i] >> 16 ;
+      if ( nb > 3 ) *donnees++ = v[i] >> 24 ;
+    }
+  return donnees - octets ;
+}
+
+/*
+ * Pour chaque octet de contrôle : le nombre d'octets de données
+ * et le masque de "pshufb" (-1 met un octet à 0).
+ */
+
+static unsigned char longueurs[256] ;
+static signed char masques[256][16] ;
+
+static void initialise_tables()
+{
+  int c, j, b, position ;
+
+  for(c=0; c<256; c++)
+    {
+      position = 0 ;
+      for(j=0; j<4; j++)
+	for(b=0; b<4; b++)
+	  masques[c][4*j + b] = b <= ((c >> (2*j)) & 3) ? position++ : -1 ;
+      longueurs[c] = position ;
+    }
+}
+
+/*
+ * Décodage des entiers un par un, pour la fin du tableau
+ * ou si le processeur n'a pas SSSE3.
+ * "i" est le premier entier à décoder, "donnees" ses octets.
+ * Retourne la position après le dernier octet lu.
+ */
+
+static const unsigned char *decode_vbyte_portable(const unsigned char *controle
+						  , const unsigned char *donnees
+						  , unsigned int *v
+						  , size_t i, size_t n)
+{
+  int nb, b ;
+
+  for( ; i<n; i++)
+    {
+      nb = ((controle[i/4] >> (2 * (i % 4))) & 3) + 1 ;
+      v[i] = 0 ;
+      for(b=0; b<nb; b++)
+	v[i] |= (unsigned int)*donnees++ << (8*b) ;
+    }
+  return donnees ;
+}
+
+/*
+ * Les versions utilisant les instructions spécifiques :
+ * elles décodent les groupes de 4 entiers tant qu'il reste
+ * 16 octets lisibles (ou 32 pour AVX2) et retournent
+ * le nombre d'entiers décodés dans "*i".
+ */
+
+#ifdef VBYTE_X86_64
+__attribute__((target("ssse3")))
+static const unsigned char *decode_vbyte_ssse3(const unsigned char *controle
+					       , const unsigned char *donnees
+					       , const unsigned char *fin
+					       , unsigned int *v
+					       , size_t *i, size_t n)
+{
+  __m128i d ;
+
+  for( ; *i + 4 <= n && donnees + 16 <= fin; *i += 4)
+    {
+      d = _mm_loadu_si128((const __m128i*)donnees) ;
+      d = _mm_shuffle_epi8(d, _mm_loadu_si128((const __m128i*)masques[*controle])) ;
+      _mm_storeu_si128((__m128i*)(v + *i), d) ;
+      donnees += longueurs[*controle++] ;
+    }
+  return donnees ;
+}
+
+__attribute__((target("avx2")))
+static const unsigned char *decode_vbyte_avx2(const unsigned char *controle
+					      , const unsigned char *donnees
+					      , const unsigned char *fin
+					      , unsigned int *v
+					      , size_t *i, size_t n)
+{
+  __m256i d, m ;
+  const unsigned char *milieu ;
+
+  for( ; *i + 8 <= n && donnees + 32 <= fin; *i += 8)
+    {
+      milieu = donnees + longueurs[controle[0]] ;
+      d = _mm256_inserti128_si256(
+	     _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)donnees))
+	     , _mm_loadu_si128((const __m128i*)milieu), 1) ;
+      m = _mm256_inserti128_si256(
+	     _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)masques[controle[0]]))
+	     , _mm_loadu_si128((const __m128i*)masques[controle[1]]), 1) ;
+      _mm256_storeu_si256((__m256i*)(v + *i), _mm256_shuffle_epi8(d, m)) ;
+      donnees = milieu + longueurs[controle[1]] ;
+      controle += 2 ;
+    }
+  return donnees ;
+}
+#endif
+
+/*
+ * Version choisie au premier appel : NULL si il n'y a que la portable.
+ */
+
+static Booleen tables_initialisees = Faux ;
+static const unsigned char *(*fct_decode_vbyte)(const unsigned char*
+						 , const unsigned char*
+						 , const unsigned char*
+						 , unsigned int*
+						 , size_t*, size_t) = NULL ;
+
+static void choix_decode_vbyte()
+{
+  initialise_tables() ;
+#ifdef VBYTE_X86_64
+  if ( __builtin_cpu_supports("avx2") )
+    fct_decode_vbyte = decode_vbyte_avx2 ;
+  else if ( __builtin_cpu_supports("ssse3") )
+    fct_decode_vbyte = decode_vbyte_ssse3 ;
+#endif
+  tables_initialisees = Vrai ;
+}
+
+/*
+ * Décode "n" entiers à partir des "taille" octets.
+ * Retourne le nombre d'octets utilisés.
+ *
+ * Si il n'y a pas assez d'octets on lance l'exception
+ *         Exception_fichier_lecture
+ */
+
+size_t decode_vbyte(const unsigned char *octets, size_t taille
+		    , unsigned int *v, size_t n)
+{
+  const unsigned char *controle = octets ;
+  const unsigned char *donnees = octets + NB_CONTROLES(n) ;
+  const unsigned char *fin = octets + taille ;
+  size_t i, nb ;
+
+  if ( !tables_initialisees )
+    choix_decode_vbyte() ;
+
+  if ( NB_CONTROLES(n) > taille )
+    EXCEPTION_LANCE(Exception_fichier_lecture) ;
+  for(nb=0, i=0; i<NB_CONTROLES(n); i++)
+    nb += longueurs[controle[i]] ;
+  //Le dernier octet de contrôle peut décrire moins de 4 entiers
+  for(i=n; i%4; i++)
+    nb -= ((controle[i/4] >> (2 * (i % 4))) & 3) + 1 ;
+  if ( nb > fin - donnees )
+    EXCEPTION_LANCE(Exception_fichier_lecture) ;
+
+  i = 0 ;
+  if ( fct_decode_vbyte )
+    donnees = (*fct_decode_vbyte)(controle, donnees, fin, v, &i, n) ;
+  donnees = decode_vbyte_portable(controle, donnees, v, i, n) ;
+
+  return donnees - octets ;
+}
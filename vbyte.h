@@ -0,0 +1,15 @@
+/*
+ * Codage des entiers par octets (à la "stream-vbyte")
+ */
+
+#ifndef _HOME_EXCO_REDACTEX_COURS_TRANS_COMP_IMAGE_TP_DCT2_VBYTE_H
+#define _HOME_EXCO_REDACTEX_COURS_TRANS_COMP_IMAGE_TP_DCT2_VBYTE_H
+
+#include "bases.h"
+#include "bit.h"
+
+size_t taille_max_vbyte(size_t n) ;
+size_t code_vbyte(const unsigned int *v, size_t n, unsigned char *octets) ;
+size_t decode_vbyte(const unsigned char *octets, size_t taille, unsigned int *v, size_t n) ;
+
+#endif
@@ -0,0 +1,89 @@
+#include "vbyte.h"
+#include "exception.h"
+
+void taille_max_vbyte_tst()
+{
+  if ( taille_max_vbyte(0) != 0 || taille_max_vbyte(1) != 5
+       || taille_max_vbyte(4) != 17 || taille_max_vbyte(5) != 22 )
+    {
+      eprintf("Mauvaise taille maximum\n") ;
+      return ;
+    }
+}
+
+void code_vbyte_tst()
+{
+  static unsigned int v[] = { 1, 0x100, 0x10000, 0x1000000, 0xFF } ;
+  static unsigned char ok[] = { 0xE4, 0x00
+				, 0x01
+				, 0x00, 0x01
+				, 0x00, 0x00, 0x01
+				, 0x00, 0x00, 0x00, 0x01
+				, 0xFF } ;
+  unsigned char t[100] ;
+  size_t taille ;
+  int i ;
+
+  taille = code_vbyte(v, TAILLE(v), t) ;
+  if ( taille != sizeof(ok) )
+    {
+      eprintf("%lu octets au lieu de %lu\n", (unsigned long)taille
+	      , (unsigned long)sizeof(ok)) ;
+      return ;
+    }
+  for(i=0; i<sizeof(ok); i++)
+    if ( t[i] != ok[i] )
+      {
+	eprintf("L'octet %d vaut %02x au lieu de %02x\n", i, t[i], ok[i]) ;
+	return ;
+      }
+}
+
+void decode_vbyte_tst()
+{
+  static unsigned int v[10000], w[10000+1] ;
+  static unsigned char t[5*10000] ;
+  size_t taille, n ;
+  int i, r ;
+
+  for(i=0; i<TAILLE(v); i++)
+    v[i] = (unsigned int)rand() >> (rand() % 32) ;
+
+  /*
+   * Toutes les longueurs pour passer par la fin portable
+   */
+  for(n=0; n<TAILLE(v); n += n < 40 ? 1 : 997)
+    {
+      taille = code_vbyte(v, n, t) ;
+      w[n] = 1234 ;
+      if ( decode_vbyte(t, taille, w, n) != taille )
+	{
+	  eprintf("Le décodage de %lu entiers n'utilise pas tout\n"
+		  , (unsigned long)n) ;
+	  return ;
+	}
+      if ( memcmp(v, w, n*sizeof(*v)) || w[n] != 1234 )
+	{
+	  eprintf("Mauvais décodage de %lu entiers\n", (unsigned long)n) ;
+	  return ;
+	}
+    }
+
+  /*
+   * Un flot tronqué
+   */
+  taille = code_vbyte(v, 100, t) ;
+  r = 0 ;
+  EXCEPTION(decode_vbyte(t, taille-1, w, 100) ;
+	    ,
+	    ,
+	    case Exception_fichier_lecture:
+	    r = 1 ;
+	    break ;
+	    ) ;
+  if ( r != 1 )
+    {
+      eprintf("Pas d'exception sur un flot tronqué\n") ;
+      return ;
+    }
+}
@@ -0,0 +1,351 @@
+#include "vitter.h"
+#include "bits.h"
+
+/*
+ * Huffman adaptatif en une passe, algorithme "Lambda" de Vitter.
+ *
+ * Comme dans "sf.c", l'arbre commence avec la seule feuille ESCAPE
+ * (de poids 0, appelée NYT chez Vitter). Une valeur inconnue est
+ * envoyée avec le code de ESCAPE suivi de ses 32 bits, puis ESCAPE
+ * est remplacé par un noeud dont les fils sont ESCAPE et la
+ * nouvelle feuille.
+ *
+ * Les noeuds sont rangés dans un tableau par ordre de numérotation
+ * DÉCROISSANTE : la racine est la case 0, ESCAPE la dernière case.
+ * L'arbre respecte toujours :
+ *    - les poids ne diminuent pas quand on monte dans la numérotation
+ *      (donc quand l'indice diminue),
+ *    - à poids égal, les feuilles sont numérotées avant
+ *      les noeuds internes,
+ *    - les deux fils d'un noeud sont dans des cases voisines.
+ * Un "bloc" est un ensemble de noeuds de même poids et de même type.
+ *
+ * Ce sont les contenus des cases (poids, fils, valeur) qui se
+ * déplacent, chaque case garde son père : échanger deux cases
+ * échange les deux sous-arbres.
+ *
+ * Pour incrémenter un noeud, on le fait glisser au-dessus du bloc
+ * suivant (noeuds internes de même poids pour une feuille,
+ * feuilles de poids+1 pour un noeud interne) avant d'augmenter
+ * son poids. Cela minimise la somme des longueurs et la plus grande
+ * longueur des codes parmi les arbres de Huffman.
+ */
+
+/*
+ * ESCAPE est reconnu par sa place et non par sa valeur :
+ * toutes les valeurs entières peuvent être codées.
+ */
+
+#define ESCAPE(v) ((v)->nb_noeuds - 1)
+#define FEUILLE(v, i) ((v)->noeuds[i].fils < 0)
+
+struct noeud_vitter
+{
+  int poids ;
+  int fils ;			/* Première case des fils, -1 : feuille */
+  int valeur ;			/* Si feuille */
+} ;
+
+struct case_vitter
+{
+  int valeur ;
+  int noeud ;			/* -1 : case vide */
+} ;
+
+struct vitter
+{
+  int nb_noeuds ;
+  int taille ;			/* Cases allouées */
+  struct noeud_vitter *noeuds ;
+  int *pere ;			/* Père de chaque case, -1 : racine */
+  struct case_vitter *index ;	/* Hachage valeur -> case */
+  int taille_index ;		/* Puissance de 2 */
+  int nb_index ;		/* Cases de l'index utilisées */
+  unsigned char *chemin ;	/* Bits du code, de la feuille à la racine */
+} ;
+
+static unsigned int hache(int valeur, int taille)
+{
+  return ((unsigned int)valeur * 2654435761u) & (taille - 1) ;
+}
+
+/*
+ * Case de l'index où est (ou doit être) la valeur
+ */
+
+static struct case_vitter *case_index(const struct vitter *v, int valeur)
+{
+  unsigned int i ;
+
+  for(i = hache(valeur, v->taille_index) ;
+      v->index[i].noeud >= 0 && v->index[i].valeur != valeur ;
+      i = (i + 1) & (v->taille_index - 1))
+    ;
+  return &v->index[i] ;
+}
+
+static void agrandit_index(struct vitter *v)
+{
+  struct case_vitter *ancien = v->index ;
+  int i, taille = v->taille_index ;
+
+  v->taille_index = taille ? 2*taille : 64 ;
+  ALLOUER(v->index, v->taille_index) ;
+  for(i = 0; i < v->taille_index; i++)
+    v->index[i].noeud = -1 ;
+  for(i = 0; i < taille; i++)
+    if ( ancien[i].noeud >= 0 )
+      *case_index(v, ancien[i].valeur) = ancien[i] ;
+  free(ancien) ;
+}
+
+static void agrandit_noeuds(struct vitter *v)
+{
+  v->taille = 2*v->taille ;
+  v->noeuds = realloc(v->noeuds, v->taille * sizeof(*v->noeuds)) ;
+  v->pere = realloc(v->pere, v->taille * sizeof(*v->pere)) ;
+  v->chemin = realloc(v->chemin, v->taille * sizeof(*v->chemin)) ;
+  if ( v->noeuds == NULL || v->pere == NULL || v->chemin == NULL )
+    {
+      fprintf(stderr, "Plus de memoire\n") ;
+      EXIT ;
+    }
+}
+
+struct vitter* open_vitter()
+{
+  struct vitter *v ;
+
+  ALLOUER(v, 1) ;
+  v->taille = 64 ;
+  ALLOUER(v->noeuds, v->taille) ;
+  ALLOUER(v->pere, v->taille) ;
+  ALLOUER(v->chemin, v->taille) ;
+  v->index = NULL ;
+  v->taille_index = 0 ;
+  v->nb_index = 0 ;
+  agrandit_index(v) ;
+
+  v->nb_noeuds = 1 ;
+  v->noeuds[0].poids = 0 ;
+  v->noeuds[0].fils = -1 ;
+  v->noeuds[0].valeur = 0 ;
+  v->pere[0] = -1 ;
+  return v ;
+}
+
+void close_vitter(struct vitter *v)
+{
+  free(v->noeuds) ;
+  free(v->pere) ;
+  free(v->chemin) ;
+  free(v->index) ;
+  free(v) ;
+}
+
+/*
+ * Après un déplacement, les liens vers le contenu de la case "i"
+ */
+
+static void relie(struct vitter *v, int i)
+{
+  if ( v->noeuds[i].fils >= 0 )
+    v->pere[v->noeuds[i].fils] = v->pere[v->noeuds[i].fils + 1] = i ;
+  else if ( i != ESCAPE(v) )
+    case_index(v, v->noeuds[i].valeur)->noeud = i ;
+}
+
+/*
+ * Echange les sous-arbres des cases "a" et "b"
+ * (aucune n'est l'ancêtre de l'autre).
+ */
+
+static void echange(struct vitter *v, int a, int b)
+{
+  struct noeud_vitter t ;
+
+  if ( a == b )
+    return ;
+  t = v->noeuds[a] ;
+  v->noeuds[a] = v->noeuds[b] ;
+  v->noeuds[b] = t ;
+  relie(v, a) ;
+  relie(v, b) ;
+}
+
+/*
+ * Fait glisser "p" au-dessus du bloc qui le suit puis augmente
+ * son poids. Retourne le prochain noeud à incrémenter : le nouveau
+ * père pour une feuille, l'ancien père pour un noeud interne.
+ */
+
+static int glisse_et_incremente(struct vitter *v, int p)
+{
+  int poids = v->noeuds[p].poids ;
+  int ancien_pere = v->pere[p] ;
+  int feuille = FEUILLE(v, p) ;
+  int q ;
+
+  for(q = p - 1; q >= 0 && q != ancien_pere; q--)
+    {
+      if ( feuille
+	   ? v->noeuds[q].poids != poids
+	   : v->noeuds[q].poids != poids + FEUILLE(v, q) )
+	break ;
+      echange(v, q + 1, q) ;
+    }
+  p = q + 1 ;
+  v->noeuds[p].poids++ ;
+  return feuille ? v->pere[p] : ancien_pere ;
+}
+
+/*
+ * Le plus haut noeud du bloc de "p"
+ */
+
+static int chef(const struct vitter *v, int p)
+{
+  while( p > 0
+	 && FEUILLE(v, p - 1) == FEUILLE(v, p)
+	 && v->noeuds[p - 1].poids == v->noeuds[p].poids )
+    p-- ;
+  return p ;
+}
+
+/*
+ * Met à jour l'arbre après le codage de la feuille "p".
+ */
+
+static void mise_a_jour(struct vitter *v, int p, int evenement)
+{
+  int feuille_a_incrementer = -1 ;
+  int escape, i ;
+
+  if ( p == ESCAPE(v) )
+    {
+      /* ESCAPE devient un noeud, de fils la nouvelle feuille
+       * et ESCAPE, tous deux numérotés après tous les autres.
+       */
+      if ( v->nb_noeuds + 2 > v->taille )
+	agrandit_noeuds(v) ;
+      escape = v->nb_noeuds + 1 ;
+      v->noeuds[p].fils = v->nb_noeuds ;
+      v->noeuds[escape - 1].poids = 0 ;
+      v->noeuds[escape - 1].fils = -1 ;
+      v->noeuds[escape - 1].valeur = evenement ;
+      v->noeuds[escape].poids = 0 ;
+      v->noeuds[escape].fils = -1 ;
+      v->noeuds[escape].valeur = 0 ;
+      v->pere[escape - 1] = v->pere[escape] = p ;
+      v->nb_noeuds += 2 ;
+      if ( 2 * (v->nb_index + 1) > v->taille_index )
+	agrandit_index(v) ;
+      case_index(v, evenement)->valeur = evenement ;
+      case_index(v, evenement)->noeud = escape - 1 ;
+      v->nb_index++ ;
+      feuille_a_incrementer = escape - 1 ;
+    }
+  else
+    {
+      escape = ESCAPE(v) ;
+      i = chef(v, p) ;
+      echange(v, i, p) ;
+      p = i ;
+      if ( v->pere[p] == v->pere[escape] )
+	{
+	  feuille_a_incrementer = p ;
+	  p = v->pere[p] ;
+	}
+    }
+  while( p >= 0 )
+    p = glisse_et_incremente(v, p) ;
+  if ( feuille_a_incrementer >= 0 )
+    glisse_et_incremente(v, feuille_a_incrementer) ;
+}
+
+void put_entier_vitter(struct bitstream *bs, struct vitter *v, int evenement)
+{
+  int p, i, n, nb ;
+  Buffer_Bit mot ;
+
+  p = case_index(v, evenement)->noeud ;
+  if ( p < 0 )
+    p = ESCAPE(v) ;
+
+  /* Le chemin se lit de la feuille vers la racine,
+   * on l'écrit à l'envers par mots.
+   */
+  n = 0 ;
+  for(i = p; v->pere[i] >= 0; i = v->pere[i])
+    v->chemin[n++] = i != v->noeuds[v->pere[i]].fils ;
+  while( n )
+    {
+      nb = n > (int)NB_BITS_MOT ? (int)NB_BITS_MOT : n ;
+      mot = 0 ;
+      for(i = 0; i < nb; i++)
+	mot = (mot << 1) | v->chemin[--n] ;
+      put_mot(bs, nb, mot) ;
+    }
+  if ( p == ESCAPE(v) )
+    put_bits(bs, sizeof(int)*8, evenement) ;
+
+  mise_a_jour(v, p, evenement) ;
+}
+
+int get_entier_vitter(struct bitstream *bs, struct vitter *v)
+{
+  int p, evenement ;
+
+  for(p = 0; v->noeuds[p].fils >= 0; )
+    p = v->noeuds[p].fils + get_bit(bs) ;
+  if ( p == ESCAPE(v) )
+    evenement = get_bits(bs, sizeof(int)*8) ;
+  else
+    evenement = v->noeuds[p].valeur ;
+
+  mise_a_jour(v, p, evenement) ;
+  return evenement ;
+}
+
+/*
+ * Pour les tests
+ */
+
+int vitter_get_nb_feuilles(const struct vitter *v)
+{
+  return v->nb_noeuds / 2 ;	/* Sans ESCAPE */
+}
+
+int vitter_arbre_ok(const struct vitter *v)
+{
+  int i, f ;
+
+  if ( v->pere[0] != -1
+       || !FEUILLE(v, ESCAPE(v)) || v->noeuds[ESCAPE(v)].poids != 0 )
+    return 0 ;
+  for(i = 0; i < v->nb_noeuds; i++)
+    {
+      f = v->noeuds[i].fils ;
+      if ( f >= 0 )
+	{
+	  if ( f <= i || f + 1 >= v->nb_noeuds
+	       || v->pere[f] != i || v->pere[f + 1] != i
+	       || v->noeuds[i].poids
+	       != v->noeuds[f].poids + v->noeuds[f + 1].poids )
+	    return 0 ;
+	}
+      else if ( i != ESCAPE(v)
+		&& case_index(v, v->noeuds[i].valeur)->noeud != i )
+	return 0 ;
+      if ( i > 0 )
+	{
+	  /* Poids croissants, feuilles avant noeuds à poids égal */
+	  if ( v->noeuds[i].poids > v->noeuds[i-1].poids )
+	    return 0 ;
+	  if ( v->noeuds[i].poids == v->noeuds[i-1].poids
+	       && FEUILLE(v, i-1) && !FEUILLE(v, i) )
+	    return 0 ;
+	}
+    }
+  return 1 ;
+}
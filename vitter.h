@@ -0,0 +1,22 @@
+/*
+ * Huffman adaptatif (algorithme de Vitter)
+ */
+
+#ifndef _HOME_EXCO_REDACTEX_COURS_TRANS_COMP_IMAGE_TP_DCT2_VITTER_H
+#define _HOME_EXCO_REDACTEX_COURS_TRANS_COMP_IMAGE_TP_DCT2_VITTER_H
+
+#include "bitstream.h"
+
+struct vitter ;
+
+struct vitter* open_vitter() ;
+void close_vitter(struct vitter *v) ;
+void put_entier_vitter(struct bitstream *bs, struct vitter *v, int evenement) ;
+int get_entier_vitter(struct bitstream *bs, struct vitter *v) ;
+
+/* Pour les tests */
+
+int vitter_get_nb_feuilles(const struct vitter *v) ; /**/
+int vitter_arbre_ok(const struct vitter *v) ; /**/
+
+#endif
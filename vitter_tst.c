@@ -0,0 +1,163 @@
+#include "vitter.h"
+#include "exception.h"
+#include "bits.h"
+
+void open_vitter_tst()
+{
+  struct vitter *v ;
+
+  v = open_vitter() ;
+  if ( v == NULL )
+    {
+      eprintf("Elle retourne NULL !\n") ;
+      return ;
+    }
+  if ( vitter_get_nb_feuilles(v) != 0 || !vitter_arbre_ok(v) )
+    {
+      eprintf("L'arbre initial ne contient pas que ESCAPE\n") ;
+      return ;
+    }
+  close_vitter(v) ;
+}
+
+void close_vitter_tst()
+{
+  close_vitter(open_vitter()) ;
+}
+
+/*
+ * Après 1000 fois la même valeur, elle doit coûter un seul bit
+ * et l'arbre doit toujours être correct.
+ */
+
+void put_entier_vitter_tst()
+{
+  struct bitstream *bs ;
+  struct vitter *v ;
+  int i ;
+  unsigned long long avant ;
+
+  bs = open_bitstream("xxx", "w") ;
+  v = open_vitter() ;
+  for(i = 0; i < 2000; i++)
+    {
+      put_entier_vitter(bs, v, i < 1000 ? 5 : i % 7) ;
+      if ( !vitter_arbre_ok(v) )
+	{
+	  eprintf("Arbre incorrect après l'ajout numéro %d\n", i) ;
+	  return ;
+	}
+    }
+  if ( vitter_get_nb_feuilles(v) != 7 )
+    {
+      eprintf("%d feuilles au lieu de 7\n", vitter_get_nb_feuilles(v)) ;
+      return ;
+    }
+  close_vitter(v) ;
+  close_bitstream(bs) ;
+
+  bs = open_bitstream_comptage() ;
+  v = open_vitter() ;
+  for(i = 0; i < 1000; i++)
+    put_entier_vitter(bs, v, -3) ;
+  put_entier_vitter(bs, v, 8) ;
+  avant = bitstream_nb_bits(bs) ;
+  put_entier_vitter(bs, v, -3) ;
+  if ( bitstream_nb_bits(bs) - avant != 1 )
+    {
+      eprintf("La valeur fréquente est codée sur %d bits\n"
+	      , (int)(bitstream_nb_bits(bs) - avant)) ;
+      return ;
+    }
+  close_vitter(v) ;
+  close_bitstream(bs) ;
+}
+
+/*
+ * Relecture de valeurs de toutes tailles, avec beaucoup de
+ * valeurs différentes pour faire grandir l'arbre.
+ */
+
+void get_entier_vitter_tst()
+{
+  struct bitstream *bs ;
+  struct vitter *v ;
+  int i, j, lu ;
+  static int valeurs[100000] ;
+  static int debut[] = { 3, 2147483647, 4, 4, 9, 2147483647 } ;
+
+  for(i = 0; i < TAILLE(valeurs); i++)
+    {
+      j = (i * 7919) % 1009 ;
+      valeurs[i] = i % 3 ? j % 10 - 5 : (j - 500) * 4099 ;
+    }
+  valeurs[10] = -2147483647 - 1 ;
+  valeurs[11] = 2147483646 ;
+
+  bs = open_bitstream("xxx", "w") ;
+  v = open_vitter() ;
+  for(i = 0; i < TAILLE(valeurs); i++)
+    put_entier_vitter(bs, v, valeurs[i]) ;
+  close_vitter(v) ;
+  close_bitstream(bs) ;
+
+  bs = open_bitstream("xxx", "r") ;
+  v = open_vitter() ;
+  for(i = 0; i < TAILLE(valeurs); i++)
+    {
+      lu = get_entier_vitter(bs, v) ;
+      if ( lu != valeurs[i] )
+	{
+	  eprintf("Valeur numéro %d : lu %d au lieu de %d\n"
+		  , i, lu, valeurs[i]) ;
+	  return ;
+	}
+    }
+  if ( !vitter_arbre_ok(v) )
+    {
+      eprintf("Arbre incorrect après la relecture\n") ;
+      return ;
+    }
+  close_vitter(v) ;
+  close_bitstream(bs) ;
+
+  /* La plus grande valeur est une valeur comme les autres */
+  for(i = 0; i < 1000; i++)
+    valeurs[i] = i < TAILLE(debut) ? debut[i]
+      : i % 3 ? 2147483647 : i % 5 ;
+
+  bs = open_bitstream("xxx", "w") ;
+  v = open_vitter() ;
+  for(i = 0; i < 1000; i++)
+    {
+      put_entier_vitter(bs, v, valeurs[i]) ;
+      if ( !vitter_arbre_ok(v) )
+	{
+	  eprintf("Arbre incorrect après l'ajout numéro %d de %d\n"
+		  , i, valeurs[i]) ;
+	  return ;
+	}
+    }
+  close_vitter(v) ;
+  close_bitstream(bs) ;
+
+  bs = open_bitstream("xxx", "r") ;
+  v = open_vitter() ;
+  for(i = 0; i < 1000; i++)
+    {
+      lu = get_entier_vitter(bs, v) ;
+      if ( lu != valeurs[i] || !vitter_arbre_ok(v) )
+	{
+	  eprintf("Valeur numéro %d : lu %d au lieu de %d\n"
+		  , i, lu, valeurs[i]) ;
+	  return ;
+	}
+    }
+  if ( vitter_get_nb_feuilles(v) != 7 )
+    {
+      eprintf("%d feuilles au lieu de 7\n", vitter_get_nb_feuilles(v)) ;
+      return ;
+    }
+  close_vitter(v) ;
+  close_bitstream(bs) ;
+}